@@ -44,6 +44,7 @@
 
 
     #include "CO_driver.h"
+    #include "CO_timer.h"
     #include "CO_OD.h"
     #include "CO_SDO.h"
     #include "CO_Emergency.h"
@@ -51,8 +52,14 @@
     #include "CO_SYNC.h"
     #include "CO_PDO.h"
     #include "CO_HBconsumer.h"
-    #include "CO_timer.h"
-#if CO_NO_SDO_CLIENT == 1
+    #include "CO_DCF.h"
+#if CO_NO_TIME > 0
+    #include "CO_TIME.h"
+#endif
+#if CO_NO_EM_CONS > 0
+    #include "CO_EMconsumer.h"
+#endif
+#if CO_NO_SDO_CLIENT > 0
     #include "CO_SDOmaster.h"
 #endif
 
@@ -105,11 +112,21 @@ typedef struct{
     CO_EMpr_t          *EMpr;           /**< Emergency process object */
     CO_NMT_t           *NMT;            /**< NMT object */
     CO_SYNC_t          *SYNC;           /**< SYNC object */
+#if CO_NO_TIME > 0
+    CO_TIME_t          *TIME;           /**< TIME object */
+#endif
     CO_RPDO_t          *RPDO[CO_NO_RPDO];/**< RPDO objects */
     CO_TPDO_t          *TPDO[CO_NO_TPDO];/**< TPDO objects */
+    CO_TPDOmonitor_t   *TPDOmon;        /**< Monitor of conflicting TPDO producers */
     CO_HBconsumer_t    *HBcons;         /**<  Heartbeat consumer object*/
-#if CO_NO_SDO_CLIENT == 1
-    CO_SDOclient_t     *SDOclient;      /**< SDO client object */
+    CO_NMTevents_t     *NMTevents;      /**< NMT and Heartbeat state change events */
+#if CO_NO_EM_CONS > 0
+    CO_EMcons_t        *EMcons;         /**< Emergency consumer object */
+#endif
+    CO_DCF_t           *DCF;            /**< Concise DCF object */
+#if CO_NO_SDO_CLIENT > 0
+    CO_SDOclient_t     *SDOclient[CO_NO_SDO_CLIENT];/**< SDO client objects */
+    CO_SDOclientEngine_t *SDOclientEngine;/**< SDO client engine, uses all SDO client objects */
 #endif
 }CO_t;
 
@@ -0,0 +1,145 @@
+/**
+ * CANopen Concise DCF (Device Configuration File) object.
+ *
+ * @file        CO_DCF.h
+ * @ingroup     CO_DCF
+ * @version     SVN: \$Id: CO_DCF.h 32 2013-03-11 08:24:27Z jani22 $
+ * @author      Janez Paternoster
+ * @copyright   2013 Janez Paternoster
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _CO_DCF_H
+#define _CO_DCF_H
+
+
+/**
+ * @defgroup CO_DCF Concise DCF
+ * @ingroup CO_CANopen
+ * @{
+ *
+ * CANopen Concise DCF object (index 0x1F22), see CiA DS302.
+ *
+ * Concise DCF is a domain, which contains many Object dictionary values. It
+ * is written with one SDO transfer (usually block transfer), so the
+ * configuration of the device does not need one SDO request/response per
+ * value. Each value is written into @ref CO_SDO_objectDictionary with
+ * CO_SDO_writeOD(), so all verifications and @ref CO_SDO_OD_function
+ * are applied as with normal SDO download.
+ *
+ * Device accepts Concise DCF on the sub-index of 0x1F22 equal to its own
+ * node-ID. Data are parsed while they are received, so size of the Concise
+ * DCF is not limited by #CO_SDO_BUFFER_SIZE. Values are written as soon as
+ * they are received. If error occurs, SDO transfer is aborted, values
+ * received before the error stay written.
+ *
+ * ####Contents of Concise DCF (all values are little-endian)
+ *
+ *   Bytes | Description
+ *   ------|-----------------------------------------------------------
+ *     4   | Number of entries.
+ *     2   | Index of the first entry.
+ *     1   | Sub-index of the first entry.
+ *     4   | Data size of the first entry, n.
+ *     n   | Data of the first entry.
+ *    ...  | Next entries.
+ *
+ * Concise DCF can be built with CO_DCF_addEntry() and downloaded to remote
+ * node with CO_SDOclientEngine_DCF().
+ */
+
+
+/**
+ * Object dictionary index of the Concise DCF.
+ */
+    #define CO_DCF_INDEX                0x1F22
+
+
+/**
+ * Concise DCF object, device side. Object is initialized by CO_DCF_init().
+ */
+typedef struct{
+    CO_SDO_t           *SDO;            /**< From CO_DCF_init() */
+    /** Internal state of the parser */
+    uint8_t             state;
+    /** Number of bytes received in headerBuffer or valueBuffer */
+    uint32_t            bufferOffset;
+    /** Number of entries, which are not yet written */
+    uint32_t            entriesLeft;
+    /** Index of the current entry */
+    uint16_t            index;
+    /** Sub-index of the current entry */
+    uint8_t             subIndex;
+    /** Data size of the current entry */
+    uint32_t            dataSize;
+    /** Number of entries written from the last Concise DCF. Can be read by
+    the application. */
+    uint32_t            entriesWritten;
+    /** Buffer for number of entries and for header of one entry */
+    uint8_t             headerBuffer[7];
+    /** Buffer for data of one entry */
+    uint8_t             valueBuffer[CO_SDO_BUFFER_SIZE];
+}CO_DCF_t;
+
+
+/**
+ * Initialize Concise DCF object.
+ *
+ * Function must be called in the communication reset section.
+ *
+ * @param DCF This object will be initialized.
+ * @param SDO SDO server object.
+ *
+ * @return #CO_ReturnError_t CO_ERROR_NO.
+ */
+int16_t CO_DCF_init(
+        CO_DCF_t               *DCF,
+        CO_SDO_t               *SDO);
+
+
+/**
+ * Add entry to the Concise DCF.
+ *
+ * Helper function for building Concise DCF, for example on network master.
+ * Before first call, dcf buffer must be prepared by setting *pDcfLength to zero.
+ *
+ * @param dcf Buffer with Concise DCF.
+ * @param dcfSize Size of the above buffer.
+ * @param pDcfLength Pointer to length of data in dcf buffer, updated by the function.
+ * @param index Index of the entry.
+ * @param subIndex Sub-index of the entry.
+ * @param data Data of the entry, little-endian.
+ * @param dataSize Size of data.
+ *
+ * @return 0: Success.
+ * @return -2: Wrong arguments or buffer too small.
+ */
+int8_t CO_DCF_addEntry(
+        uint8_t                *dcf,
+        uint32_t                dcfSize,
+        uint32_t               *pDcfLength,
+        uint16_t                index,
+        uint8_t                 subIndex,
+        const uint8_t          *data,
+        uint32_t                dataSize);
+
+
+/** @} */
+#endif
@@ -0,0 +1,204 @@
+/**
+ * CANopen Emergency consumer object.
+ *
+ * @file        CO_EMconsumer.h
+ * @ingroup     CO_EMconsumer
+ * @version     SVN: \$Id: CO_EMconsumer.h 32 2013-03-11 08:24:27Z jani22 $
+ * @author      Janez Paternoster
+ * @copyright   2013 Janez Paternoster
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _CO_EM_CONS_H
+#define _CO_EM_CONS_H
+
+
+/**
+ * @defgroup CO_EMconsumer Emergency consumer
+ * @ingroup CO_CANopen
+ * @{
+ *
+ * CANopen Emergency consumer protocol (index 0x1028).
+ *
+ * Emergency consumer receives Emergency messages from remote nodes. Each
+ * subindex of _Emergency consumer object_ (index 0x1028) contains COB-ID of
+ * one consumed Emergency: bits 0..10 are CAN identifier, bit 31 set means
+ * entry is not valid. Only CAN identifiers 0x081..0x0FF (default Emergency
+ * COB-IDs of nodes 1..127) are supported.
+ *
+ * All consumed Emergencies are received with one CAN receive buffer, which
+ * accepts the whole range 0x080..0x0FF. SYNC message, which uses 0x080 by
+ * default, must therefore have lower index in the receive buffer array.
+ * Receive interrupt finds the entry from CAN identifier with a table
+ * lookup, so the cost does not depend on the number of consumed nodes.
+ *
+ * For each entry last #CO_EM_CONS_HISTORY Emergency messages are kept
+ * together with the time of reception, taken with getTimeNow_us() inside
+ * the receive interrupt. Older messages are overwritten. Application reads
+ * them with CO_EMcons_getHistory(). Entries are identified by nodeId, which
+ * is CAN identifier minus 0x080 and is equal to the Node-ID of the producer
+ * with default COB-IDs.
+ *
+ * If CO_EMcons_initCallback() is called, application function is called
+ * from the receive interrupt for each consumed Emergency, so the application
+ * may react within the same SYNC cycle. Function must be short.
+ */
+
+
+/**
+ * Number of Emergency messages kept for each consumed node. Must be power
+ * of 2.
+ */
+    #ifndef CO_EM_CONS_HISTORY
+        #define CO_EM_CONS_HISTORY          4
+    #endif
+
+
+/**
+ * One received Emergency message.
+ */
+typedef struct{
+    /** Local time of reception in [microseconds], from getTimeNow_us() */
+    uint32_t            timestamp;
+    /** Emergency message, see @ref CO_Emergency */
+    uint8_t             data[8];
+}CO_EMconsMsg_t;
+
+
+/**
+ * One consumed node inside CO_EMcons_t.
+ */
+typedef struct{
+    /** Last received messages, used as a ring */
+    CO_EMconsMsg_t      history[CO_EM_CONS_HISTORY];
+    /** Number of received messages, written by receive interrupt only */
+    volatile uint16_t   rxCount;
+    /** Number of valid messages in history */
+    volatile uint8_t    noOfMsgs;
+    /** CAN identifier of the entry or 0, if entry is not valid */
+    uint16_t            COB_ID;
+}CO_EMconsNode_t;
+
+
+/**
+ * Emergency consumer object.
+ *
+ * Object is initialized by CO_EMcons_init(). It contains an array of
+ * CO_EMconsNode_t objects.
+ */
+typedef struct{
+    uint8_t            *operatingState; /**< From CO_EMcons_init() */
+    CO_EMconsNode_t    *nodes;          /**< From CO_EMcons_init() */
+    uint8_t             numberOfNodes;  /**< From CO_EMcons_init() */
+    /** Index into nodes for each CAN identifier 0x081..0x0FF, 0xFF if
+    Emergency with that identifier is not consumed. */
+    uint8_t             nodeIndex[127];
+    /** From CO_EMcons_initCallback() or NULL */
+    void              (*pFunctSignal)(void *object, uint8_t nodeId, const CO_EMconsMsg_t *msg);
+    /** From CO_EMcons_initCallback() */
+    void               *functSignalObject;
+    CO_CANmodule_t     *CANdevRx;       /**< From CO_EMcons_init() */
+    uint16_t            CANdevRxIdx;    /**< From CO_EMcons_init() */
+}CO_EMcons_t;
+
+
+/**
+ * Initialize Emergency consumer object.
+ *
+ * Function must be called in the communication reset section. CO_timer.h
+ * must be initialized with initTimer().
+ *
+ * @param EMcons This object will be initialized.
+ * @param SDO SDO server object.
+ * @param operatingState Pointer to variable indicating CANopen device NMT internal state.
+ * @param EMconsCOB_ID Pointer to _Emergency consumer object_ array from
+ * Object Dictionary (index 0x1028). Size of array is equal to numberOfNodes.
+ * @param nodes Pointer to the externaly defined array of the same size as
+ * numberOfNodes.
+ * @param numberOfNodes Total size of the above arrays, 1..127.
+ * @param CANdevRx CAN device for Emergency reception.
+ * @param CANdevRxIdx Index of receive buffer in the above CAN device.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_EMcons_init(
+        CO_EMcons_t            *EMcons,
+        CO_SDO_t               *SDO,
+        uint8_t                *operatingState,
+        const uint32_t         *EMconsCOB_ID,
+        CO_EMconsNode_t        *nodes,
+        uint8_t                 numberOfNodes,
+        CO_CANmodule_t         *CANdevRx,
+        uint16_t                CANdevRxIdx);
+
+
+/**
+ * Initialize Emergency consumer callback.
+ *
+ * Function may be called by application after CO_EMcons_init() or later.
+ * Callback is called from the CAN receive interrupt, after the message is
+ * written into history.
+ *
+ * @param EMcons This object.
+ * @param object Pointer to object, passed to pFunctSignal. May be NULL.
+ * @param pFunctSignal Callback function, NULL disables callback. Its
+ * arguments are object, nodeId of the producer and received message.
+ */
+void CO_EMcons_initCallback(
+        CO_EMcons_t            *EMcons,
+        void                   *object,
+        void                  (*pFunctSignal)(void *object, uint8_t nodeId, const CO_EMconsMsg_t *msg));
+
+
+/**
+ * Read Emergency message from history.
+ *
+ * Function may be called from mainline. It briefly disables interrupts.
+ *
+ * @param EMcons This object.
+ * @param nodeId CAN identifier of the consumed Emergency minus 0x080 (1..127).
+ * @param age 0 for the last received message, 1 for the previous, and so on,
+ * up to CO_EM_CONS_HISTORY - 1.
+ * @param msg Received message will be copied here.
+ *
+ * @return 1 if message exists, 0 if node is not consumed or history is shorter.
+ */
+uint8_t CO_EMcons_getHistory(
+        CO_EMcons_t            *EMcons,
+        uint8_t                 nodeId,
+        uint8_t                 age,
+        CO_EMconsMsg_t         *msg);
+
+
+/**
+ * Get number of Emergency messages received from node.
+ *
+ * @param EMcons This object.
+ * @param nodeId CAN identifier of the consumed Emergency minus 0x080 (1..127).
+ *
+ * @return Number of received messages (overflows) or 0, if node is not consumed.
+ */
+uint16_t CO_EMcons_getCount(
+        CO_EMcons_t            *EMcons,
+        uint8_t                 nodeId);
+
+
+/** @} */
+#endif
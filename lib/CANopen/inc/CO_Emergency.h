@@ -67,6 +67,52 @@
  * ####Contents of _Pre Defined Error Field_ (object dictionary, index 0x1003):
  * bytes 0..3 are equal to bytes 0..3 in the Emergency message.
  *
+ * Array from Object dictionary is used as a ring, so each new error is
+ * written in constant time. Reading of index 0x1003 from SDO presents it in
+ * standard order: subindex 1 is the newest error. Application should read it
+ * through SDO as well, not directly from the array.
+ *
+ * ####Reporting from any context
+ * CO_errorReport() and CO_errorReset() do not use locks and do not disable
+ * interrupts, so they may be called from mainline and from interrupts of any
+ * priority at the same time. Error status bit is changed with atomic
+ * read-modify-write, so exactly one caller sees the transition and queues
+ * the emergency. Emergencies are queued in a multi-producer single-consumer
+ * ring: producer reserves a slot by compare-and-swap of the write counter,
+ * writes it and publishes it with the sequence number of the slot.
+ * CO_EM_process() is the only consumer. Producer never waits for another
+ * producer, even if it interrupted that producer inside its reservation. If
+ * the ring is full, emergency is counted in CO_EM_t::bufOverflow and in
+ * CO_EM_t::bufOverflowTotal. CO_EM_process() then reports
+ * ERROR_EMERGENCY_BUFFER_FULL with the number of lost messages. Counter is
+ * decreased only by the number, which was reported. If further messages are
+ * lost, while ERROR_EMERGENCY_BUFFER_FULL is still set, it is reset first and
+ * reported again with the new number, so no report is lost silently. This is
+ * done only, when the ring has a free slot, and failure of the
+ * ERROR_EMERGENCY_BUFFER_FULL report itself is not counted as a loss.
+ * Atomic operations are provided by CO_driver.h.
+ *
+ * ####Storm suppression
+ * Flapping error condition (reported and reset again and again) produces an
+ * emergency on each transition. If #CO_EM_STORM_WINDOW is nonzero,
+ * CO_EM_process() opens a window of that length after the emergency for
+ * specific error condition is sent. Further emergencies for the same error
+ * condition inside the window are not sent, they are only counted and the
+ * last one is kept. When window expires, the last one is sent as a single
+ * aggregated emergency and a new window is opened. Emergencies of up to
+ * #CO_EM_STORM_SLOTS error conditions are tracked at the same time, others
+ * are sent as usual. Aggregated emergency has the following contents:
+ *
+ *   Byte | Description
+ *   -----|-----------------------------------------------------------
+ *   0..3 | As in the last collapsed Emergency message.
+ *   4..5 | Bits 0..15 of the additional argument of the last one.
+ *   6..7 | Number of collapsed Emergency messages (saturated at 0xFFFF).
+ *
+ * Latest state of the error condition is therefore always sent, at latest
+ * one window after it changes. _Pre Defined Error Field_ receives only sent
+ * emergencies.
+ *
  * @see @ref CO_CANopen_identifiers
  */
 
@@ -214,21 +260,21 @@
     #define ERROR_CAN_RXB_OVERFLOW                     0x13, 0x8110 /**< CAN module receive buffer has overflowed */
     #define ERROR_CAN_TX_OVERFLOW                      0x14, 0x8110 /**< CAN transmit buffer has overflowed */
     #define ERROR_TPDO_OUTSIDE_WINDOW                  0x15, 0x8100 /**< TPDO is outside SYNC window */
-    #define ERROR_16_unused                            0x16, 0x1000 /**< (unused) */
-    #define ERROR_17_unused                            0x17, 0x1000 /**< (unused) */
+    #define ERROR_RPDO_TIME_OUT                        0x16, 0x8250 /**< RPDO was not received within its event timer */
+    #define ERROR_TPDO_COB_ID_CONFLICT                 0x17, 0x8100 /**< Another device transmits COB-ID of own TPDO */
     #define ERROR_SYNC_TIME_OUT                        0x18, 0x8100 /**< SYNC message timeout */
     #define ERROR_SYNC_LENGTH                          0x19, 0x8240 /**< Unexpected SYNC data length */
     #define ERROR_PDO_WRONG_MAPPING                    0x1A, 0x8200 /**< Error with PDO mapping */
     #define ERROR_HEARTBEAT_CONSUMER                   0x1B, 0x8130 /**< Heartbeat consumer timeout */
     #define ERROR_HEARTBEAT_CONSUMER_REMOTE_RESET      0x1C, 0x8130 /**< Heartbeat consumer detected remote node reset */
-    #define ERROR_1D_unused                            0x1D, 0x1000 /**< (unused) */
+    #define ERROR_PDO_NO_COB_ID                        0x1D, 0x8100 /**< Allocated default COB-ID of PDO does not exist for this PDO and node-ID */
     #define ERROR_1E_unused                            0x1E, 0x1000 /**< (unused) */
     #define ERROR_1F_unused                            0x1F, 0x1000 /**< (unused) */
 /** @} */
 /** @name Informative generic errors */
 /** @{ */
     #define ERROR_EMERGENCY_BUFFER_FULL                0x20, 0x1000 /**< Emergency buffer is full, Emergency message wasn't sent */
-    #define ERROR_ERROR_REPORT_BUSY                    0x21, 0x1000 /**< CO_errorReport() is busy, Emergency message wasn't sent */
+    #define ERROR_21_unused                            0x21, 0x1000 /**< (unused) */
     #define ERROR_MICROCONTROLLER_RESET                0x22, 0x1000 /**< Microcontroller has just started */
     #define ERROR_23_unused                            0x23, 0x1000 /**< (unused) */
     #define ERROR_24_unused                            0x24, 0x1000 /**< (unused) */
@@ -251,10 +297,38 @@
 
 
 /**
- * Size of internal buffer, whwre emergencies are stored after CO_errorReport().
- * Buffer is cleared by CO_EM_process().
+ * Size of internal buffer, where emergencies are stored after CO_errorReport().
+ * Buffer is cleared by CO_EM_process(). Must be power of 2.
+ */
+#define CO_EM_INTERNAL_BUFFER_SIZE      16
+
+
+/**
+ * Length of storm suppression window in [100 * microseconds], see
+ * @ref CO_Emergency. 0 disables storm suppression.
+ */
+    #ifndef CO_EM_STORM_WINDOW
+        #define CO_EM_STORM_WINDOW          0
+    #endif
+
+
+/**
+ * Number of error conditions tracked by storm suppression at the same time.
  */
-#define CO_EM_INTERNAL_BUFFER_SIZE      10
+    #ifndef CO_EM_STORM_SLOTS
+        #define CO_EM_STORM_SLOTS           8
+    #endif
+
+
+/**
+ * One slot of the internal emergency buffer.
+ */
+typedef struct{
+    /** Slot is free for write counter equal to sequence and holds message for
+    read counter equal to sequence - 1. */
+    volatile uint16_t   sequence;
+    uint8_t             data[8];        /**< Emergency message */
+}CO_EMslot_t;
 
 
 /**
@@ -266,18 +340,37 @@ typedef struct{
     uint8_t            *errorStatusBits;/**< From CO_EM_init() */
     uint8_t             errorStatusBitsSize;/**< From CO_EM_init() */
     /** Internal buffer for storing unsent emergency messages.*/
-    uint8_t             buf[CO_EM_INTERNAL_BUFFER_SIZE * 8];
-    uint8_t            *bufEnd;         /**< End+1 address of the above buffer */
-    uint8_t            *bufWritePtr;    /**< Write pointer in the above buffer */
-    uint8_t            *bufReadPtr;     /**< Read pointer in the above buffer */
-    uint8_t             bufFull;        /**< True if above buffer is full */
+    CO_EMslot_t         buf[CO_EM_INTERNAL_BUFFER_SIZE];
+    /** Write counter, incremented by producers with compare-and-swap */
+    volatile uint16_t   bufWriteCnt;
+    /** Read counter, used by CO_EM_process() only */
+    uint16_t            bufReadCnt;
+    /** Number of emergencies lost, because the above buffer was full, and
+    not yet reported with ERROR_EMERGENCY_BUFFER_FULL */
+    volatile uint16_t   bufOverflow;
+    /** Total number of emergencies lost, because the above buffer was full.
+    Can be read by the application. */
+    volatile uint32_t   bufOverflowTotal;
     uint8_t             wrongErrorReport;/**< Error in arguments to CO_errorReport() */
-    uint8_t             errorReportBusy;/**< Lock mechanism for CO_errorReport() */
-    /** Error, higher priority task called CO_errorReport() while it was busy */
-    uint8_t             errorReportBusyError;
 }CO_EM_t;
 
 
+#if CO_EM_STORM_WINDOW > 0
+/**
+ * Storm suppression window for one error condition, see @ref CO_Emergency.
+ */
+typedef struct{
+    /** Time from the start of the window in [100 * microseconds] */
+    uint16_t            timer;
+    /** Number of emergencies collapsed in the window. If window expired and
+    count is 0, slot is free. */
+    uint16_t            count;
+    uint8_t             errorBit;       /**< Error condition of the window */
+    uint8_t             data[8];        /**< Last collapsed emergency message */
+}CO_EMstorm_t;
+#endif
+
+
 /**
  * Report error condition.
  *
@@ -286,15 +379,14 @@ typedef struct{
  * after the first occurance of specific error. In case of critical error, device
  * will not be able to stay in NMT_OPERATIONAL state.
  *
- * Function is short and may be used form any task or interrupt.
+ * Function is short, lock-free and may be used form any task or interrupt.
  *
  * @param EM Emergency object.
  * @param errorBit, errorCode Use macro from @ref CO_EM_errorStatusBits.
  * @param infoCode 32 bit value is passed to bytes 4...7 of the Emergency message.
  * It contains optional additional information inside emergency message.
  *
- * @return -3: CO_errorReport is busy, message is deleted.
- * @return -2: Emergency buffer is full, message is deleted.
+ * @return -2: Emergency buffer is full, message is counted as lost.
  * @return -1: Error in arguments.
  * @return  0: Error was already present before, no action was performed.
  * @return  1: Error is new, Emergency will be send.
@@ -308,14 +400,13 @@ int8_t CO_errorReport(CO_EM_t *EM, uint8_t errorBit, uint16_t errorCode, uint32_
  * Function is called if any error condition is solved. Emergency message is sent
  * with @ref CO_EM_errorCode 0x0000.
  *
- * Function is short and may be used form any task or interrupt.
+ * Function is short, lock-free and may be used form any task or interrupt.
  *
  * @param EM Emergency object.
  * @param errorBit, errorCode Use macro from @ref CO_EM_errorStatusBits.
  * @param infoCode 32 bit value is passed to bytes 4...7 of the Emergency message.
  *
- * @return -3: CO_errorReport is busy, message is deleted.
- * @return -2: Emergency buffer is full, message is deleted.
+ * @return -2: Emergency buffer is full, message is counted as lost.
  * @return -1: Error in arguments.
  * @return  0: Error was already present before, no action was performed.
  * @return  1: Error bit is cleared, Emergency with @ref CO_EM_errorCode 0 will be send.
@@ -354,7 +445,18 @@ typedef struct{
     uint32_t           *preDefErr;      /**< From CO_EM_init() */
     uint8_t             preDefErrSize;  /**< From CO_EM_init() */
     uint8_t             preDefErrNoOfErrors;/**< Number of active errors in preDefErr */
+    uint8_t             preDefErrNewest;/**< Index of the newest error in preDefErr */
+    /** Number of CO_EM_process() calls with communication error present. May
+    be read by the application. */
+    uint32_t            commErrorCount;
     uint16_t            inhibitEmTimer; /**< Internal timer for emergency message */
+#if CO_EM_STORM_WINDOW > 0
+    /** Storm suppression windows */
+    CO_EMstorm_t        storm[CO_EM_STORM_SLOTS];
+    /** Number of emergencies collapsed by storm suppression since
+    CO_EM_init(). May be read by the application. */
+    uint32_t            stormCollapsedCount;
+#endif
     CO_EM_t            *EM;             /**< CO_EM_t sub object is included here */
     CO_CANmodule_t     *CANdev;         /**< From CO_EM_init() */
     CO_CANtx_t         *CANtxBuff;      /**< CAN transmit buffer */
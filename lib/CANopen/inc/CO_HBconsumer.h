@@ -43,6 +43,25 @@
  * variable _allMonitoredOperational_ inside CO_HBconsumer_t is set to true.
  * Monitoring starts after the reception of the first HeartBeat (not bootup).
  *
+ * ####Scaling to many monitored nodes
+ * Up to 127 nodes may be monitored. All Heartbeat messages (CAN identifiers
+ * 0x701..0x77F) are received with one CAN receive buffer. Receive interrupt
+ * finds the monitored node from CAN identifier with a table lookup and puts
+ * it into a queue for CO_HBconsumer_process(), if it is not already there.
+ *
+ * Each monitored node, which has started monitoring, has its absolute
+ * deadline in a binary min-heap. CO_HBconsumer_process() handles only the
+ * queued nodes, each in O(log n), and then removes expired deadlines from the
+ * top of the heap. So time spent in CO_HBconsumer_process() is proportional
+ * to the received Heartbeats and expired deadlines, not to the number of
+ * monitored nodes. Timed out node is removed from the heap, until its next
+ * Heartbeat. _allMonitoredOperational_ is calculated from the count of
+ * operational nodes.
+ *
+ * If CO_HBconsumer_initEvents() is called, changes of NMT state of monitored
+ * nodes (including boot-up) and Heartbeat timeouts are put into NMT event
+ * queue, see @ref CO_NMT_Heartbeat.
+ *
  * @see  @ref CO_NMT_Heartbeat
  */
 
@@ -53,9 +72,16 @@
 typedef struct{
     uint8_t             NMTstate;       /**< Of the remote node */
     uint8_t             monStarted;     /**< True after reception of the first Heartbeat mesage */
-    uint16_t            timeoutTimer;   /**< Time since last heartbeat received */
     uint16_t            time;           /**< Consumer heartbeat time from OD */
-    uint8_t             CANrxNew;       /**< True if new Heartbeat message received from the CAN bus */
+    uint8_t             nodeId;         /**< Node-ID of the monitored node or 0 */
+    uint8_t             heapPos;        /**< Position in CO_HBconsumer_t::heap or 0xFF */
+    /** Absolute time of Heartbeat timeout in [milliseconds], see
+    CO_HBconsumer_t::timeNow_ms */
+    uint32_t            deadline;
+    volatile uint8_t    CANrxNew;       /**< True if new Heartbeat message received from the CAN bus */
+    volatile uint8_t    rxNMTstate;     /**< NMT state from the received message */
+    /** Time of reception of the received message, from getTimeNow_us() */
+    uint32_t            rxTimestamp;
 }CO_HBconsNode_t;
 
 
@@ -73,8 +99,29 @@ typedef struct{
     /** True, if all monitored nodes are NMT operational or no node is
         monitored. Can be read by the application */
     uint8_t             allMonitoredOperational;
+    /** Number of nodes with nonzero consumer heartbeat time */
+    uint8_t             noOfMonitored;
+    /** Number of monitored nodes in NMT operational */
+    uint8_t             noOfOperational;
+    /** True, if this node was NMT pre-operational or operational in the
+    previous call to CO_HBconsumer_process() */
+    uint8_t             wasPreOrOperational;
+    /** Index into monitoredNodes for each Node-ID 1..127, 0xFF if not monitored */
+    uint8_t             nodeIndex[127];
+    /** Binary min-heap of indexes into monitoredNodes, ordered by deadline */
+    uint8_t             heap[127];
+    uint8_t             heapSize;       /**< Number of nodes in heap */
+    /** Queue of indexes into monitoredNodes with received Heartbeat, written
+    by receive interrupt */
+    uint8_t             rxQueue[128];
+    volatile uint8_t    rxQueueWr;      /**< Write counter of rxQueue */
+    uint8_t             rxQueueRd;      /**< Read counter of rxQueue */
+    /** Time in [milliseconds], sum of timeDifference_ms from
+    CO_HBconsumer_process() */
+    uint32_t            timeNow_ms;
+    CO_NMTevents_t     *events;         /**< From CO_HBconsumer_initEvents() or NULL */
     CO_CANmodule_t     *CANdevRx;       /**< From CO_HBconsumer_init() */
-    uint16_t            CANdevRxIdxStart; /**< From CO_HBconsumer_init() */
+    uint16_t            CANdevRxIdx;    /**< From CO_HBconsumer_init() */
 }CO_HBconsumer_t;
 
 
@@ -90,10 +137,10 @@ typedef struct{
  * from Object Dictionary (index 0x1016). Size of array is equal to numberOfMonitoredNodes.
  * @param monitoredNodes Pointer to the externaly defined array of the same size
  * as numberOfMonitoredNodes.
- * @param numberOfMonitoredNodes Total size of the above arrays.
+ * @param numberOfMonitoredNodes Total size of the above arrays, 1..127.
  * @param CANdevRx CAN device for Heartbeat reception.
- * @param CANdevRxIdxStart Starting index of receive buffer in the above CAN device.
- * Number of used indexes is equal to numberOfMonitoredNodes.
+ * @param CANdevRxIdx Index of receive buffer in the above CAN device. One
+ * buffer is used for all monitored nodes.
  *
  * @return #CO_ReturnError_t CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
  */
@@ -105,7 +152,20 @@ int16_t CO_HBconsumer_init(
         CO_HBconsNode_t        *monitoredNodes,
         uint8_t                 numberOfMonitoredNodes,
         CO_CANmodule_t         *CANdevRx,
-        uint16_t                CANdevRxIdxStart);
+        uint16_t                CANdevRxIdx);
+
+
+/**
+ * Initialize Heartbeat consumer events.
+ *
+ * Function may be called after CO_HBconsumer_init().
+ *
+ * @param HBcons This object.
+ * @param events NMT event queue, NULL disables events.
+ */
+void CO_HBconsumer_initEvents(
+        CO_HBconsumer_t        *HBcons,
+        CO_NMTevents_t         *events);
 
 
 /**
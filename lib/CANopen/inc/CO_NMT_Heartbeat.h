@@ -61,6 +61,23 @@
  *
  * @see @ref CO_CANopen_identifiers
  *
+ * ###NMT state events
+ * Changes of NMT state can be collected in CO_NMTevents_t queue. Local
+ * transitions are put into the queue by CO_NMT_receive() and
+ * CO_NMT_process(), if CO_NMT_initEvents() was called. Transitions of remote
+ * nodes are put into the queue by Heartbeat consumer, see
+ * CO_HBconsumer_initEvents(). Each event has a timestamp from
+ * getTimeNow_us(). For a remote node it is the time of reception of the
+ * Heartbeat message inside the receive interrupt, for a timeout it is the
+ * time of its detection. CO_NMTevents_process() is called from the mainline
+ * and passes all queued events to the application callback. Without the
+ * callback application reads events with CO_NMTevents_get(). Local
+ * transitions are not missed, until the queue overflows. For remote nodes
+ * Heartbeat consumer holds one received message per node until
+ * CO_HBconsumer_process(), further Heartbeats of that node are rejected
+ * until then. So at most one transition per remote node is recorded
+ * between two calls to CO_HBconsumer_process().
+ *
  * ###Status LED diodes
  * Macros for @ref CO_NMT_statusLEDdiodes are also implemented in this object.
  */
@@ -111,6 +128,57 @@ typedef enum{
 }CO_NMT_commands;
 
 
+/**
+ * Size of NMT event queue, see @ref CO_NMT_Heartbeat. Must be power of 2.
+ */
+    #ifndef CO_NMT_EVENT_QUEUE_SIZE
+        #define CO_NMT_EVENT_QUEUE_SIZE     16
+    #endif
+
+
+/**
+ * Type of NMT event.
+ */
+typedef enum{
+    CO_NMT_EVENT_STATE_CHANGE       = 0,    /**< NMT state of the node changed */
+    CO_NMT_EVENT_BOOTUP             = 1,    /**< Boot-up message received from remote node */
+    CO_NMT_EVENT_HB_TIMEOUT         = 2     /**< Heartbeat of remote node timed out */
+}CO_NMT_eventType;
+
+
+/**
+ * NMT event, see @ref CO_NMT_Heartbeat.
+ */
+typedef struct{
+    /** Local time of the event in [microseconds], from getTimeNow_us() */
+    uint32_t            timestamp;
+    uint8_t             type;           /**< See #CO_NMT_eventType */
+    /** Node-ID of the node, which changed the state. It is own Node-ID for
+    local transitions. */
+    uint8_t             nodeId;
+    uint8_t             oldState;       /**< Previous #CO_NMT_internalState */
+    /** New #CO_NMT_internalState, CO_NMT_INITIALIZING on boot-up and timeout */
+    uint8_t             newState;
+}CO_NMTevent_t;
+
+
+/**
+ * Queue of NMT events. Object is initialized by CO_NMTevents_init().
+ */
+typedef struct{
+    CO_NMTevent_t       buf[CO_NMT_EVENT_QUEUE_SIZE]; /**< Event buffer */
+    volatile uint8_t    writeCnt;       /**< Write counter */
+    volatile uint8_t    readCnt;        /**< Read counter */
+    /** Number of events lost, because queue was full. May be read by the
+    application. */
+    uint16_t            overflow;
+    /** From CO_NMTevents_initCallback() or NULL */
+    void              (*pFunctSignal)(void *object, const CO_NMTevent_t *event);
+    /** From CO_NMTevents_initCallback() */
+    void               *functSignalObject;
+}CO_NMTevents_t;
+
+
 /**
  * NMT consumer and Heartbeat producer object. It includes also variables for
  * @ref CO_NMT_statusLEDdiodes. Object is initialized by CO_NMT_init().
@@ -133,9 +201,89 @@ typedef struct{
     CO_EMpr_t          *EMpr;           /**< From CO_NMT_init() */
     CO_CANmodule_t     *HB_CANdev;      /**< From CO_NMT_init() */
     CO_CANtx_t         *HB_TXbuff;      /**< CAN transmit buffer */
+    CO_NMTevents_t     *events;         /**< From CO_NMT_initEvents() or NULL */
+    /** Number of CO_NMT_process() calls with CAN bus passive present. May be
+    read by the application. */
+    uint32_t            CANpassiveCount;
+    /** Number of times error behavior (index 0x1029) forced the device out of
+    operational state. May be read by the application. */
+    uint32_t            errorBehaviorCount;
 }CO_NMT_t;
 
 
+/**
+ * Initialize NMT event queue.
+ *
+ * @param events This object will be initialized.
+ */
+void CO_NMTevents_init(CO_NMTevents_t *events);
+
+
+/**
+ * Initialize NMT event callback.
+ *
+ * Function may be called by application after CO_NMTevents_init() or later.
+ * Callback is called from CO_NMTevents_process() for each event.
+ *
+ * @param events This object.
+ * @param object Pointer to object, passed to pFunctSignal. May be NULL.
+ * @param pFunctSignal Callback function, NULL disables callback.
+ */
+void CO_NMTevents_initCallback(
+        CO_NMTevents_t         *events,
+        void                   *object,
+        void                  (*pFunctSignal)(void *object, const CO_NMTevent_t *event));
+
+
+/**
+ * Put event into NMT event queue.
+ *
+ * Function may be called from mainline or interrupt. It briefly disables
+ * interrupts.
+ *
+ * @param events This object.
+ * @param timestamp Time of the event from getTimeNow_us().
+ * @param type See #CO_NMT_eventType.
+ * @param nodeId Node-ID of the node.
+ * @param oldState Previous NMT state.
+ * @param newState New NMT state.
+ *
+ * @return 1 on success, 0 if queue is full.
+ */
+uint8_t CO_NMTevents_put(
+        CO_NMTevents_t         *events,
+        uint32_t                timestamp,
+        uint8_t                 type,
+        uint8_t                 nodeId,
+        uint8_t                 oldState,
+        uint8_t                 newState);
+
+
+/**
+ * Get the oldest event from NMT event queue.
+ *
+ * Function must be called from mainline.
+ *
+ * @param events This object.
+ * @param event Event will be copied here.
+ *
+ * @return 1 if event was copied, 0 if queue is empty.
+ */
+uint8_t CO_NMTevents_get(CO_NMTevents_t *events, CO_NMTevent_t *event);
+
+
+/**
+ * Process NMT event queue.
+ *
+ * Function must be called cyclically from mainline. If callback is
+ * registered, it is called for each queued event and queue is emptied.
+ * Otherwise events stay in queue for CO_NMTevents_get().
+ *
+ * @param events This object.
+ */
+void CO_NMTevents_process(CO_NMTevents_t *events);
+
+
 /**
  * Initialize NMT and Heartbeat producer object.
  *
@@ -169,6 +317,17 @@ int16_t CO_NMT_init(
         uint16_t                CANidTxHB);
 
 
+/**
+ * Initialize NMT events for local transitions.
+ *
+ * Function may be called after CO_NMT_init(), see @ref CO_NMT_Heartbeat.
+ *
+ * @param NMT This object.
+ * @param events NMT event queue, NULL disables events.
+ */
+void CO_NMT_initEvents(CO_NMT_t *NMT, CO_NMTevents_t *events);
+
+
 /**
  * Calculate blinking bytes.
  *
@@ -55,14 +55,273 @@
  *  - Function CO_TPDO_process() (called by application) sends TPDO if
  *    necessary. There are possible different transmission types, including
  *    automatic detection of Change of State of specific variable.
+ *
+ * ####RPDO deadline monitoring
+ * If _event timer_ of RPDO (index 0x1400+, subindex 5) is different than zero,
+ * RPDO is expected to be received within that time in [milliseconds].
+ * Monitoring starts with the first RPDO received in NMT operational. If
+ * deadline expires, CO_RPDO_process() reports ERROR_RPDO_TIME_OUT emergency
+ * with COB-ID as additional information. Error is reset, when the RPDO is
+ * received again. Monitoring stops outside NMT operational. Reception time is
+ * taken with CO_timer.h, which must be initialized with initTimer().
+ *
+ * ####RPDO inter-arrival statistics
+ * If CO_RPDO_initStatistics() is called, time between two consecutive
+ * receptions of the RPDO in NMT operational is measured. Statistics are
+ * written into array of UNSIGNED32 from Object dictionary:
+ *  - element 0: Number of measured intervals.
+ *  - element 1: Minimum interval in [microseconds].
+ *  - element 2: Maximum interval in [microseconds].
+ *  - element 3: Mean interval in [microseconds], averaged over approximately
+ *    the last #CO_RPDO_STATISTICS_AVERAGE intervals.
+ *  - element 4: Maximum jitter, the largest difference between interval and
+ *    mean interval, in [microseconds].
+ *  - element 5: Number of deadline overruns, see RPDO deadline monitoring.
+ *  - element 6 (optional): Number of receive overruns, see RPDO receive buffer.
+ *
+ * Writing to any element of the array clears the statistics.
+ *
+ * ####RPDO receive buffer
+ * Received RPDO is copied into CO_RPDO_t::CANrxData inside the receive
+ * interrupt. If CO_RPDO_process() did not process the previous message yet,
+ * it is overwritten, so the latest message always wins, and
+ * CO_RPDO_t::rxOverrun is incremented. CO_RPDO_process() copies the buffer
+ * under the sequence counter CO_RPDO_t::CANrxSeq and repeats the copy, if
+ * receive interrupt wrote the buffer meanwhile. So mapped objects always
+ * receive all bytes from the same message, without disabling interrupts.
+ * Application may call CO_RPDO_process() less often than RPDOs arrive.
+ *
+ * ####RPDO callback
+ * If CO_RPDO_initCallback() is called, application function is called for
+ * each received RPDO in NMT operational, after data are copied to mapped
+ * objects in Object Dictionary. Function gets the PDO data, which are the
+ * mapped values in the order of mapping, each little-endian as on CAN bus.
+ * The same values may be read from the mapped variables. Function is called
+ * either:
+ *  - from CO_RPDO_process() (deferred), where data are copied as usual, or
+ *  - from receive interrupt (#CO_RPDO_CALLBACK_ISR), where mapped objects are
+ *    written by the interrupt itself. Use it only for short, hard real-time
+ *    reactions. Mainline code must then expect, that mapped multi-byte
+ *    objects change at any time. Only RPDOs with asynchronous _transmission
+ *    type_ (254, 255) are processed in receive interrupt. Synchronous RPDOs
+ *    (0..240) are always processed by CO_RPDO_process(), with deferred
+ *    callback.
+ *
+ * Time from reception of the RPDO to the callback can be measured inside the
+ * callback with getTime_us(&RPDO->rxTimestamp).
+ *
+ * ####SYNC to TPDO latency
+ * If CO_TPDO_initLatency() is called, time from the last SYNC message to the
+ * moment, when synchronous TPDO is copied into CAN transmit mailbox, is
+ * measured for each transmission. Statistics are written into array of
+ * UNSIGNED32 from Object dictionary:
+ *  - element 0: Number of measured transmissions.
+ *  - element 1: Minimum latency in [microseconds].
+ *  - element 2: Maximum latency in [microseconds].
+ *  - element 3: Number of TPDOs dropped, because synchronous window expired.
+ *  - element 4 and above: Histogram of latency. Width of each histogram bin is
+ *    #CO_TPDO_LATENCY_BIN_WIDTH, the last bin also counts all larger values.
+ *
+ * Maximum latency may be compared with _Synchronous window length_ (index
+ * 0x1007). Writing to any element of the array clears the statistics.
+ *
+ * ####Transmit offset of synchronous TPDO
+ * If CO_TPDO_initSYNCoffset() is called, synchronous TPDO due at the SYNC is
+ * not sent immediately, but after the configured time from the SYNC message
+ * has elapsed. So TPDOs from different nodes can be placed into their own time
+ * slots inside the SYNC period and do not all compete for the bus at once.
+ * Time is measured with CO_timer.h from the SYNC timestamp, resolution is
+ * given by the period of calling CO_TPDOisSYNCslot(). Offset must be smaller
+ * than _Synchronous window length_ (index 0x1007), if window is used, and
+ * smaller than SYNC period. Larger value is rejected by SDO write. If SYNC
+ * period is changed later and offset is not smaller any more, TPDO is sent
+ * without offset and ERROR_TPDO_OUTSIDE_WINDOW is reported.
+ *
+ * ####Phase spread of event timers
+ * If #CO_TPDO_PHASE_SPREAD is set to 1, TPDOs with _transmission type_ 254 or
+ * 255 and with _event timer_ do not all start transmitting at the transition
+ * to NMT operational. Instead, the first event of each TPDO is delayed by
+ * CO_TPDO_t::eventPhase part of its event timer period. After that, each TPDO
+ * keeps its own phase. _Inhibit time_ is respected as usual.
+ *
+ * ####High resolution timing
+ * By default _event timer_ is counted in milliseconds and _inhibit time_ in
+ * 100 microseconds, both by decrementing with the time differences passed to
+ * CO_TPDO_process(). If #CO_TPDO_HIGH_RES is set to 1, both are scheduled as
+ * absolute deadlines on the microsecond time base from CO_timer.h, so they do
+ * not accumulate error from processing jitter. Event period may be set in
+ * microseconds with CO_TPDO_initHighRes(), which allows TPDO rates above
+ * 1 kHz. CO_TPDO_process() must then be called often enough, for example from
+ * a fast timer interrupt.
+ *
+ * ####TPDO groups
+ * State of one device is often spread over several TPDOs, which are sent one
+ * after another. Without groups, each TPDO samples its mapped objects at the
+ * moment of its own transmission. If CO_TPDO_initGroup() is called, TPDOs with
+ * the same nonzero group number are latched together: mapped objects of all
+ * members are copied into CO_TPDO_t::groupData inside one critical section
+ * (interrupts disabled), and each member then sends its latched data with
+ * the next CO_TPDOsend(). Group data are used for one transmission only.
+ * If a member is not sent before the next latch, its group data are
+ * replaced. Group latch is separate from the data sampled at SYNC for
+ * _transmission type_ 252, and TPDOs with type 252 or 253 are not latched
+ * with the group. Latch is taken:
+ *  - by CO_TPDO_latchSYNC() for members due at the SYNC, before any of them is
+ *    sent (CO_process_TPDO() does this), or
+ *  - by CO_TPDO_latchGroup() on application request, for example at the end of
+ *    control cycle, before sendRequest is set for event driven members.
+ *
+ * Length of the critical section is proportional to the sum of data lengths
+ * of latched TPDOs, at most 8 bytes per TPDO.
+ *
+ * ####Shadow mapping
+ * Layout of process data may be changed at runtime without a gap, while PDO
+ * stays valid. If mapping parameter (index 0x1600+ or 0x1A00+) of a valid
+ * PDO is written by SDO, the usual sequence is used: write zero to
+ * subindex 0, write mapped objects, write number of mapped objects to
+ * subindex 0. Values are written into CO_RPDO_t::shadowRecord and the last
+ * write calls CO_RPDO_prepareMap() or CO_TPDO_prepareMap(). Object
+ * dictionary shows the active mapping until the swap. Application may call
+ * these functions directly with its own mapping record, for example when
+ * operating mode of the device changes. Mapping is verified and built aside
+ * from the active mapping, while PDO keeps working. Prepared mapping is
+ * swapped in with CO_RPDO_swapMap() and CO_TPDO_swapMap(), which
+ * CO_process_RPDO() and CO_process_TPDO() call at the next SYNC, so all PDOs
+ * of the device change layout at the same SYNC boundary. If SYNC is not
+ * running, they are called on the next processing. Swap takes a
+ * short critical section. Received RPDO, which was not processed yet, and
+ * data latched with the group are discarded, because they have the old
+ * layout. Mapping record in Object dictionary (index 0x1600+ or 0x1A00+) is
+ * then overwritten with the new mapping record.
+ *
+ * ####Identifiers of additional PDOs
+ * Predefined connection set gives default COB-IDs only to the first four
+ * RPDOs and TPDOs. CO_PDO_defaultCOB_ID() allocates default COB-IDs for
+ * further PDOs from the range #CO_PDO_ALLOC_BASE + 1 to #CO_PDO_ALLOC_LAST.
+ * Range is divided into blocks of #CO_PDO_ALLOC_MAX_NODE_ID identifiers, in
+ * order TPDO5, RPDO5, TPDO6, RPDO6, ... and node-ID is added to the block, the
+ * same as with predefined connection set. So identifiers are collision-free
+ * for all nodes with node-ID up to #CO_PDO_ALLOC_MAX_NODE_ID and each device
+ * can calculate identifiers of other devices.
+ *
+ * Range is small: it holds (#CO_PDO_ALLOC_LAST - #CO_PDO_ALLOC_BASE) /
+ * #CO_PDO_ALLOC_MAX_NODE_ID blocks. With default values this is 5 blocks
+ * (TPDO5, RPDO5, TPDO6, RPDO6, TPDO7) for node-IDs 1..16. For more PDOs or
+ * nodes the range must be moved or enlarged, or PDOs must be configured
+ * manually. PDOs, which do not fit into the range, and devices with higher
+ * node-ID have no default COB-ID. If their _COB-ID_ (index 0x1400+ or
+ * 0x1800+, subindex 1) still contains the first identifier of a block, it is
+ * not used, because it would overlap with other devices: PDO stays disabled
+ * and ERROR_PDO_NO_COB_ID is reported, at initialization or at SDO write.
+ *
+ * If CO_TPDOmonitor_init() is called, CAN messages, which are not accepted
+ * by any other object, are checked in constant time against default COB-IDs
+ * of own TPDOs. If another device transmits such message, own TPDO is
+ * disabled, ERROR_TPDO_COB_ID_CONFLICT is reported and identifier is stored
+ * into CO_TPDOmonitor_t::conflictCOB_ID. TPDO is enabled again by writing
+ * its _COB-ID_ (index 0x1800+, subindex 1). Only TPDOs using the default
+ * COB-ID (predefined connection set or allocated) are monitored. Conflicts
+ * on manually configured COB-IDs are not detected, because that would need a
+ * search through all TPDOs inside the receive interrupt.
+ *
+ * ####TPDO on remote transmission request
+ * If CO_TPDO_initRTR() is called, TPDO with _transmission type_ 252 or 253
+ * is sent on reception of the remote transmission request (RTR) with its
+ * COB-ID, if bit 30 of the COB-ID is not set. It is opt-in, because each such
+ * TPDO occupies one CAN receive buffer: CO_init() calls it for the first
+ * CO_NO_TPDO_RTR TPDOs (0 by default). For other _transmission types_ the
+ * receive buffer is set to identifier 0. Response is assembled and
+ * queued directly inside the CAN receive interrupt, so it follows the request
+ * within about one frame time, independent of the mainline cycle:
+ *  - 253: mapped objects are sampled at the moment of the request.
+ *  - 252: mapped objects are sampled at each SYNC by CO_TPDOisSYNC() and the
+ *    same data are sent on each request until the next SYNC. Nothing is sent
+ *    before the first SYNC.
+ *
+ * Mapped objects are read from interrupt, the same as with
+ * #CO_RPDO_CALLBACK_ISR, so multi-byte objects should be written atomically
+ * by the application.
+ */
+
+
+/**
+ * Phase spread of event timer TPDOs, see description of the @ref CO_PDO.
+ *
+ * If set to 1, CO_TPDO_t::eventPhase is used. CANopen.c sets it from TPDO
+ * number and node-ID, so TPDOs are spread evenly inside one node and
+ * shifted a little between nodes.
+ */
+    #ifndef CO_TPDO_PHASE_SPREAD
+        #define CO_TPDO_PHASE_SPREAD        0
+    #endif
+
+
+/**
+ * High resolution timing of TPDOs, see description of the @ref CO_PDO.
+ *
+ * If set to 1, _event timer_ and _inhibit time_ are handled as absolute
+ * deadlines in [microseconds]. CO_timer.h must be initialized with initTimer().
  */
+    #ifndef CO_TPDO_HIGH_RES
+        #define CO_TPDO_HIGH_RES            0
+    #endif
+
+
+/**
+ * Base of the range for default COB-IDs of PDOs beyond the fourth, see
+ * description of the @ref CO_PDO. First allocated identifier is one more.
+ */
+    #ifndef CO_PDO_ALLOC_BASE
+        #define CO_PDO_ALLOC_BASE           0x680
+    #endif
+
+
+/**
+ * Last identifier of the range for default COB-IDs of additional PDOs.
+ */
+    #ifndef CO_PDO_ALLOC_LAST
+        #define CO_PDO_ALLOC_LAST           0x6DF
+    #endif
+
+
+/**
+ * Highest node-ID on the network, which gets allocated COB-IDs of additional
+ * PDOs. It is also size of one block of allocated identifiers.
+ */
+    #ifndef CO_PDO_ALLOC_MAX_NODE_ID
+        #define CO_PDO_ALLOC_MAX_NODE_ID    16
+    #endif
+
+
+/**
+ * Calling modes for CO_RPDO_initCallback().
+ */
+    #define CO_RPDO_CALLBACK_DEFERRED   0   /**< Called from CO_RPDO_process() */
+    #define CO_RPDO_CALLBACK_ISR        1   /**< Called from CAN receive interrupt */
+
+
+/**
+ * Number of intervals for mean interval in RPDO inter-arrival statistics,
+ * see description of the @ref CO_PDO.
+ */
+    #ifndef CO_RPDO_STATISTICS_AVERAGE
+        #define CO_RPDO_STATISTICS_AVERAGE  16
+    #endif
+
+
+/**
+ * Width of one bin in the SYNC to TPDO latency histogram in [microseconds].
+ */
+    #ifndef CO_TPDO_LATENCY_BIN_WIDTH
+        #define CO_TPDO_LATENCY_BIN_WIDTH   100
+    #endif
 
 
 /**
  * RPDO communication parameter. The same as record from Object dictionary (index 0x1400+).
  */
 typedef struct{
-    uint8_t             maxSubIndex;    /**< Equal to 2 */
+    uint8_t             maxSubIndex;    /**< Equal to 5 */
     /** Communication object identifier for message received. Meaning of the specific bits:
         - Bit  0-10: COB-ID for PDO, to change it bit 31 must be set.
         - Bit 11-29: set to 0 for 11 bit COB-ID.
@@ -75,6 +334,13 @@ typedef struct{
         - 254:     Manufacturer specific.
         - 255:     Asynchronous. */
     uint8_t             transmissionType;
+    /** Not used */
+    uint16_t            inhibitTime;
+    /** Not used */
+    uint8_t             compatibilityEntry;
+    /** Deadline for reception of the PDO in milliseconds, see RPDO deadline
+    monitoring in @ref CO_PDO. Zero disables functionality. */
+    uint16_t            eventTimer;
 }CO_RPDOCommPar_t;
 
 
@@ -177,9 +443,44 @@ typedef struct{
     uint8_t            *mapPointer[8];
     /** Variable indicates, if new PDO message received from CAN bus.
     Must be 2-byte variable because of correct alignment of CANrxData. */
-    uint16_t            CANrxNew;
+    volatile uint16_t   CANrxNew;
     /** 8 data bytes of the received message. Take care for correct (word) alignment!*/
-    uint8_t             CANrxData[8];
+    volatile uint8_t    CANrxData[8];
+    /** Sequence counter of CANrxData, incremented before and after CANrxData
+    is written in receive interrupt. Odd value means write in progress. */
+    volatile uint16_t   CANrxSeq;
+    /** Number of received messages, which overwrote message not yet processed
+    by CO_RPDO_process(). May be read by the application. */
+    uint32_t            rxOverrun;
+    /** From CO_RPDO_initCallback() or NULL */
+    void              (*pFunctRx)(void *object, const uint8_t *data, uint8_t dataLength);
+    /** From CO_RPDO_initCallback() */
+    void               *functRxObject;
+    /** From CO_RPDO_initCallback() */
+    uint8_t             callbackMode;
+    /** Time of the last reception in NMT operational, taken with CO_timer.h */
+    ttimer              rxTimestamp;
+    /** True, if RPDO was received since transition to NMT operational. Deadline
+    monitoring and inter-arrival statistics are then active. */
+    uint8_t             rxMonitored;
+    /** True, if deadline expired and emergency was reported */
+    uint8_t             rxTimeout;
+    /** Inter-arrival statistics from CO_RPDO_initStatistics() or NULL */
+    uint32_t           *statistics;
+    /** Number of elements in the above array */
+    uint8_t             statisticsSize;
+    /** Mapping record from CO_RPDO_prepareMap() */
+    const CO_RPDOMapPar_t *shadowMapPar;
+    /** Shadow mapping, see mapPointer */
+    uint8_t            *shadowMapPointer[8];
+    /** Shadow mapping, see dataLength */
+    uint8_t             shadowDataLength;
+    /** True, if shadow mapping is prepared and waits for CO_RPDO_swapMap() */
+    uint8_t             shadowPending;
+    /** Mapping record written by SDO, while RPDO is valid. Its
+    numberOfMappedObjects is 0 while entries are written and 0xFF before the
+    first write of zero. */
+    CO_RPDOMapPar_t     shadowRecord;
     CO_CANmodule_t     *CANdevRx;       /**< From CO_RPDO_init() */
     uint16_t            CANdevRxIdx;    /**< From CO_RPDO_init() */
 }CO_RPDO_t;
@@ -211,18 +512,78 @@ typedef struct{
     uint8_t             sendIfCOSFlags;
     /** SYNC counter used for PDO sending */
     uint8_t             syncCounter;
-    /** Previous timer from CO_SYNC_t */
-    uint32_t            SYNCtimerPrevious;
     /** Inhibit timer used for inhibit PDO sending */
     uint16_t            inhibitTimer;
     /** Event timer used for PDO sending */
     uint16_t            eventTimer;
+    /** Phase of the first event after transition to NMT operational, part of
+    _event timer_ period in 1/65536 units. Used if #CO_TPDO_PHASE_SPREAD is 1. */
+    uint16_t            eventPhase;
+#if CO_TPDO_HIGH_RES == 1
+    /** Event period in [microseconds] from CO_TPDO_initHighRes() or NULL. If
+    NULL or zero, _event timer_ from communication parameter is used. */
+    const uint32_t     *eventTime_us;
+    /** Absolute time of the next event in [microseconds] */
+    uint32_t            eventDeadline;
+    /** Absolute time, when inhibit time expires, in [microseconds] */
+    uint32_t            inhibitDeadline;
+#endif
+    /** From CO_TPDO_initLatency() or NULL */
+    CO_SYNC_t          *SYNC;
+    /** SYNC to TPDO latency statistics from CO_TPDO_initLatency() or NULL */
+    uint32_t           *latency;
+    /** Number of elements in the above array */
+    uint8_t             latencySize;
+    /** Transmit offset after SYNC in [microseconds], from
+    CO_TPDO_initSYNCoffset() or NULL */
+    const uint32_t     *SYNCoffset;
+    /** True, if TPDO was due at the last SYNC and was not sent yet */
+    uint8_t             SYNCpending;
+    /** Group number from CO_TPDO_initGroup() or NULL. Zero means no group. */
+    const uint8_t      *group;
+    /** True, if groupData holds data for the next transmission. Cleared
+    after groupData were successfully passed to CO_CANsend(). */
+    uint8_t             groupLatched;
+    /** Mapped objects latched together with other members of the group */
+    uint8_t             groupData[8];
+    /** True, if latchData holds data sampled at the last SYNC */
+    uint8_t             latched;
+    /** Mapped objects sampled at SYNC for _transmission type_ 252 */
+    uint8_t             latchData[8];
+    /** Mapping record from CO_TPDO_prepareMap() */
+    const CO_TPDOMapPar_t *shadowMapPar;
+    /** Shadow mapping, see mapPointer */
+    uint8_t            *shadowMapPointer[8];
+    /** Shadow mapping, see dataLength */
+    uint8_t             shadowDataLength;
+    /** Shadow mapping, see sendIfCOSFlags */
+    uint8_t             shadowSendIfCOSFlags;
+    /** True, if shadow mapping is prepared and waits for CO_TPDO_swapMap() */
+    uint8_t             shadowPending;
+    /** Mapping record written by SDO, while TPDO is valid, see shadowRecord
+    in CO_RPDO_t */
+    CO_TPDOMapPar_t     shadowRecord;
     CO_CANmodule_t     *CANdevTx;       /**< From CO_TPDO_init() */
     CO_CANtx_t         *CANtxBuff;      /**< CAN transmit buffer inside CANdev */
     uint16_t            CANdevTxIdx;    /**< From CO_TPDO_init() */
+    CO_CANmodule_t     *CANdevRx;       /**< From CO_TPDO_initRTR() or NULL */
+    uint16_t            CANdevRxIdx;    /**< From CO_TPDO_initRTR() */
 }CO_TPDO_t;
 
 
+/**
+ * Monitor of the conflicting TPDO producers, see description of the @ref CO_PDO.
+ */
+typedef struct{
+    CO_EM_t            *EM;             /**< From CO_TPDOmonitor_init() */
+    CO_TPDO_t         **TPDO;           /**< From CO_TPDOmonitor_init() */
+    uint16_t            noOfTPDO;       /**< From CO_TPDOmonitor_init() */
+    uint8_t             nodeId;         /**< From CO_TPDOmonitor_init() */
+    /** COB-ID of the last detected conflict or zero */
+    uint16_t            conflictCOB_ID;
+}CO_TPDOmonitor_t;
+
+
 /**
  * Initialize RPDO object.
  *
@@ -268,6 +629,51 @@ int16_t CO_RPDO_init(
         uint16_t                CANdevRxIdx);
 
 
+/**
+ * Initialize RPDO inter-arrival statistics.
+ *
+ * Function may be called in the communication reset section after
+ * CO_RPDO_init(). Statistics are cleared. CO_timer.h must be initialized with
+ * initTimer().
+ *
+ * @param RPDO This object.
+ * @param SDO SDO object.
+ * @param statistics Pointer to array of UNSIGNED32 from Object dictionary, see
+ * description of the @ref CO_PDO.
+ * @param statisticsSize Number of elements in the above array, at least 6.
+ * @param index Index of the above array in Object dictionary.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_RPDO_initStatistics(
+        CO_RPDO_t              *RPDO,
+        CO_SDO_t               *SDO,
+        uint32_t               *statistics,
+        uint8_t                 statisticsSize,
+        uint16_t                index);
+
+
+/**
+ * Initialize RPDO callback.
+ *
+ * Function may be called by application after CO_RPDO_init() or later, see
+ * description of the @ref CO_PDO.
+ *
+ * @param RPDO This object.
+ * @param object Pointer to object, passed to pFunctRx. May be NULL.
+ * @param pFunctRx Callback function, NULL disables callback. Its arguments
+ * are object, PDO data and number of mapped bytes.
+ * @param callbackMode CO_RPDO_CALLBACK_DEFERRED or CO_RPDO_CALLBACK_ISR.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_RPDO_initCallback(
+        CO_RPDO_t              *RPDO,
+        void                   *object,
+        void                  (*pFunctRx)(void *object, const uint8_t *data, uint8_t dataLength),
+        uint8_t                 callbackMode);
+
+
 /**
  * Initialize TPDO object.
  *
@@ -313,6 +719,245 @@ int16_t CO_TPDO_init(
         uint16_t                CANdevTxIdx);
 
 
+/**
+ * Initialize SYNC to TPDO latency statistics.
+ *
+ * Function may be called in the communication reset section after
+ * CO_TPDO_init(). Statistics are cleared. CO_timer.h must be initialized with
+ * initTimer().
+ *
+ * @param TPDO This object.
+ * @param SDO SDO object.
+ * @param SYNC SYNC object, its timestamp is used.
+ * @param latency Pointer to array of UNSIGNED32 from Object dictionary, see
+ * description of the @ref CO_PDO.
+ * @param latencySize Number of elements in the above array, at least 5.
+ * @param index Index of the above array in Object dictionary.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_TPDO_initLatency(
+        CO_TPDO_t              *TPDO,
+        CO_SDO_t               *SDO,
+        CO_SYNC_t              *SYNC,
+        uint32_t               *latency,
+        uint8_t                 latencySize,
+        uint16_t                index);
+
+
+/**
+ * Initialize transmit offset of synchronous TPDO.
+ *
+ * Function may be called in the communication reset section after
+ * CO_TPDO_init(). CO_timer.h must be initialized with initTimer().
+ *
+ * @param TPDO This object.
+ * @param SDO SDO server object.
+ * @param SYNC SYNC object, its timestamp and period are used.
+ * @param SYNCoffset Pointer to variable with offset after SYNC in
+ * [microseconds], usually from Object dictionary. Value may be changed at
+ * runtime, zero means no offset.
+ * @param index Index of the array with offsets of all TPDOs in Object
+ * dictionary. Writes of values not smaller than SYNC period are rejected.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_TPDO_initSYNCoffset(
+        CO_TPDO_t              *TPDO,
+        CO_SDO_t               *SDO,
+        CO_SYNC_t              *SYNC,
+        const uint32_t         *SYNCoffset,
+        uint16_t                index);
+
+
+/**
+ * Initialize group of TPDO.
+ *
+ * Function may be called in the communication reset section after
+ * CO_TPDO_init(), see description of the @ref CO_PDO.
+ *
+ * @param TPDO This object.
+ * @param group Pointer to variable with group number, usually from Object
+ * dictionary. Value may be changed at runtime, zero means no group.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_TPDO_initGroup(
+        CO_TPDO_t              *TPDO,
+        const uint8_t          *group);
+
+
+/**
+ * Latch mapped objects of all TPDOs from one group.
+ *
+ * Function may be called by application in NMT operational. Latched data are
+ * sent with the next transmission of each member. Members with
+ * _transmission type_ 252 or 253 are skipped.
+ *
+ * @param TPDO Array of pointers to all TPDO objects.
+ * @param noOfTPDO Number of elements in the above array.
+ * @param group Group number, must not be zero.
+ */
+void CO_TPDO_latchGroup(
+        CO_TPDO_t              *TPDO[],
+        uint16_t                noOfTPDO,
+        uint8_t                 group);
+
+
+/**
+ * Latch mapped objects of all grouped TPDOs due at the current SYNC.
+ *
+ * Function must be called after SYNCpending was set for all TPDOs with
+ * CO_TPDOisSYNC() and before any of them is sent.
+ *
+ * @param TPDO Array of pointers to all TPDO objects.
+ * @param noOfTPDO Number of elements in the above array.
+ */
+void CO_TPDO_latchSYNC(
+        CO_TPDO_t              *TPDO[],
+        uint16_t                noOfTPDO);
+
+
+/**
+ * Prepare shadow mapping of RPDO.
+ *
+ * Function may be called by application in any NMT state, see description of
+ * the @ref CO_PDO. Previously prepared shadow mapping is discarded. Active
+ * mapping is not changed.
+ *
+ * @param RPDO This object.
+ * @param mapPar Pointer to the new mapping record. Record must stay in memory
+ * until CO_RPDO_swapMap(), it is then copied into Object dictionary.
+ *
+ * @return 0 on success, otherwise SDO abort code. Mapping with zero length is
+ * not accepted.
+ */
+uint32_t CO_RPDO_prepareMap(
+        CO_RPDO_t              *RPDO,
+        const CO_RPDOMapPar_t  *mapPar);
+
+
+/**
+ * Prepare shadow mapping of TPDO.
+ *
+ * Same as CO_RPDO_prepareMap().
+ *
+ * @param TPDO This object.
+ * @param mapPar Pointer to the new mapping record.
+ *
+ * @return 0 on success, otherwise SDO abort code.
+ */
+uint32_t CO_TPDO_prepareMap(
+        CO_TPDO_t              *TPDO,
+        const CO_TPDOMapPar_t  *mapPar);
+
+
+/**
+ * Swap prepared shadow mapping of RPDO into active mapping.
+ *
+ * Function does nothing, if shadow mapping is not prepared. It is called from
+ * CO_process_RPDO() on reception of SYNC message.
+ *
+ * @param RPDO This object.
+ */
+void CO_RPDO_swapMap(CO_RPDO_t *RPDO);
+
+
+/**
+ * Swap prepared shadow mapping of TPDO into active mapping.
+ *
+ * Function does nothing, if shadow mapping is not prepared. It is called from
+ * CO_process_TPDO() at the new SYNC, before synchronous TPDOs are determined.
+ *
+ * @param TPDO This object.
+ */
+void CO_TPDO_swapMap(CO_TPDO_t *TPDO);
+
+
+/**
+ * Initialize reception of remote transmission request for TPDO.
+ *
+ * Function may be called in the communication reset section after
+ * CO_TPDO_init(), see description of the @ref CO_PDO. Receive buffer is
+ * reconfigured, when COB-ID or _transmission type_ of the TPDO changes.
+ *
+ * @param TPDO This object.
+ * @param CANdevRx CAN device for reception of RTR.
+ * @param CANdevRxIdx Index of receive buffer in the above CAN device.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_TPDO_initRTR(
+        CO_TPDO_t              *TPDO,
+        CO_CANmodule_t         *CANdevRx,
+        uint16_t                CANdevRxIdx);
+
+
+/**
+ * Get default COB-ID of PDO.
+ *
+ * For first four PDOs from predefined connection set, for others allocated
+ * from the range, see description of the @ref CO_PDO. Value is without
+ * node-ID, so it may be used as defaultCOB_ID for CO_RPDO_init() and
+ * CO_TPDO_init().
+ *
+ * @param pdoNo PDO number, 0 for the first PDO.
+ * @param R_T 0 for RPDO, 1 for TPDO.
+ * @param nodeId CANopen Node ID of this device.
+ *
+ * @return Default COB-ID without node-ID or 0, if PDO has no default COB-ID
+ * (range is exhausted or nodeId is higher than #CO_PDO_ALLOC_MAX_NODE_ID).
+ */
+uint16_t CO_PDO_defaultCOB_ID(uint16_t pdoNo, uint8_t R_T, uint8_t nodeId);
+
+
+/**
+ * Initialize monitor of the conflicting TPDO producers.
+ *
+ * Function may be called in the communication reset section after
+ * CO_TPDO_init() for all TPDOs. Receive buffer accepts all data frames, so it
+ * must be the last one in the receive array of the CAN device.
+ *
+ * @param TM This object will be initialized.
+ * @param EM Emergency object.
+ * @param TPDO Array of pointers to all TPDO objects.
+ * @param noOfTPDO Number of elements in the above array.
+ * @param nodeId CANopen Node ID of this device.
+ * @param CANdevRx CAN device for reception.
+ * @param CANdevRxIdx Index of receive buffer in the above CAN device.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_TPDOmonitor_init(
+        CO_TPDOmonitor_t       *TM,
+        CO_EM_t                *EM,
+        CO_TPDO_t              *TPDO[],
+        uint16_t                noOfTPDO,
+        uint8_t                 nodeId,
+        CO_CANmodule_t         *CANdevRx,
+        uint16_t                CANdevRxIdx);
+
+
+#if CO_TPDO_HIGH_RES == 1
+/**
+ * Initialize high resolution event period of TPDO.
+ *
+ * Function may be called in the communication reset section after
+ * CO_TPDO_init(). Used only, if #CO_TPDO_HIGH_RES is set to 1.
+ *
+ * @param TPDO This object.
+ * @param eventTime_us Pointer to variable with event period in
+ * [microseconds], usually from Object dictionary. Value may be changed at
+ * runtime. If zero, _event timer_ from communication parameter is used.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_TPDO_initHighRes(
+        CO_TPDO_t              *TPDO,
+        const uint32_t         *eventTime_us);
+#endif
+
+
 /**
  * Verify Change of State of the PDO.
  *
@@ -330,11 +975,46 @@ int16_t CO_TPDO_init(
 uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO);
 
 
+/**
+ * Verify, if synchronous TPDO must be sent at the current SYNC.
+ *
+ * Function must be called exactly once for each received or transmitted SYNC
+ * message, for example after CO_SYNC_process() returned 1. It handles
+ * _transmission type_ 0 (sendRequest) and 1-240 (every N-th SYNC, with
+ * _SYNC start value_). Function does not send the PDO, so all TPDOs due at the
+ * SYNC can be determined first and then sent with CO_TPDOsend() in their
+ * slots, see CO_TPDOisSYNCslot() and CO_process_TPDO().
+ *
+ * @param TPDO TPDO object.
+ * @param SYNC SYNC object.
+ *
+ * @return True if TPDO must be sent.
+ */
+uint8_t CO_TPDOisSYNC(CO_TPDO_t *TPDO, CO_SYNC_t *SYNC);
+
+
+/**
+ * Verify, if time slot for sending of synchronous TPDO was reached.
+ *
+ * Function may be called cyclically. SYNCpending must be set before from
+ * CO_TPDOisSYNC(). If transmit offset is configured, see
+ * CO_TPDO_initSYNCoffset(), function waits until offset after the SYNC has
+ * elapsed. SYNCpending is cleared, when function returns true.
+ *
+ * @param TPDO TPDO object.
+ *
+ * @return True if TPDO must be sent now.
+ */
+uint8_t CO_TPDOisSYNCslot(CO_TPDO_t *TPDO);
+
+
 /**
  * Send TPDO message.
  *
- * Function prepares TPDO data from Object Dictionary variables. It should not
- * be called by application, it is called from CO_TPDO_process().
+ * Function prepares TPDO data from Object Dictionary variables or from data
+ * latched with the group, see description of the @ref CO_PDO. It should not
+ * be called by application, it is called from CO_TPDO_process() and for
+ * synchronous TPDOs after CO_TPDOisSYNC().
  *
  *
  * @param TPDO TPDO object.
@@ -350,6 +1030,7 @@ int16_t CO_TPDOsend(CO_TPDO_t *TPDO);
  * Function must be called cyclically in any NMT state. It copies data from RPDO
  * to Object Dictionary variables if: new PDO receives and PDO is valid and NMT
  * operating state is operational. It does not verify _transmission type_.
+ * It also verifies RPDO deadline, see description of the @ref CO_PDO.
  *
  * @param RPDO This object.
  */
@@ -361,16 +1042,17 @@ void CO_RPDO_process(CO_RPDO_t *RPDO);
  *
  * Function must be called cyclically in any NMT state. It prepares and sends
  * TPDO if necessary. If Change of State needs to be detected, function
- * CO_TPDOisCOS() must be called before.
+ * CO_TPDOisCOS() must be called before. Synchronous TPDOs are not sent by this
+ * function, see CO_TPDOisSYNC().
  *
  * @param TPDO This object.
- * @param SYNC SYNC object. Ignored if NULL.
  * @param timeDifference_100us Time difference from previous function call in [100 * microseconds].
+ * Not used, if #CO_TPDO_HIGH_RES is 1.
  * @param timeDifference_ms Time difference from previous function call in [milliseconds].
+ * Not used, if #CO_TPDO_HIGH_RES is 1.
  */
 void CO_TPDO_process(
         CO_TPDO_t              *TPDO,
-        CO_SYNC_t              *SYNC,
         uint16_t                timeDifference_100us,
         uint16_t                timeDifference_ms);
 
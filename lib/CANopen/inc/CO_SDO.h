@@ -311,6 +311,36 @@
     #endif
 
 
+/**
+ * Fast path for expedited SDO upload.
+ *
+ * If set to 1, expedited upload requests for plain variables (not domain,
+ * readable, 1 to 4 bytes long and without @ref CO_SDO_OD_function configured)
+ * are answered directly from the CAN receive interrupt, so response time does
+ * not depend on the period of CO_SDO_process(). All other requests are
+ * processed as usual. Variables read this way must be accessible from the
+ * interrupt context.
+ */
+    #ifndef CO_SDO_FAST_UPLOAD
+        #define CO_SDO_FAST_UPLOAD    0
+    #endif
+
+
+/**
+ * Adaptive block size in SDO block transfer.
+ *
+ * If set to 1, receiving side of the block transfer (SDO server by download,
+ * SDO client by upload) adapts the number of segments per block. Block size is
+ * halved after a block with lost segments or with CO_ERROR_RX_OVERFLOW in
+ * receive function and increased by one after a complete block, up to the
+ * maximum possible. Learned value is kept for the next transfer. Statistics of
+ * the last block transfer are available in CO_SDO_blockStats_t.
+ */
+    #ifndef CO_SDO_BLOCK_ADAPTIVE
+        #define CO_SDO_BLOCK_ADAPTIVE 0
+    #endif
+
+
 /**
  * Object Dictionary attributes. Bit masks for attribute in CO_OD_entry_t.
  */
@@ -471,6 +501,31 @@ typedef struct{
 }CO_OD_extension_t;
 
 
+/**
+ * Statistics of the last SDO block transfer, see #CO_SDO_BLOCK_ADAPTIVE.
+ *
+ * Structure is cleared at the start of the block transfer and is valid after
+ * the end of it. Segments are counted on the side, where object belongs:
+ * transmitted by download client and upload server, received otherwise.
+ */
+typedef struct{
+    /** Number of data bytes transferred */
+    uint32_t            bytes;
+    /** Duration of the transfer in milliseconds */
+    uint32_t            time_ms;
+    /** Average throughput, calculated at the end of transfer */
+    uint32_t            bytesPerSecond;
+    /** Number of segments transmitted or received */
+    uint16_t            segments;
+    /** Number of segments, which were transmitted again or discarded on reception */
+    uint16_t            retransmitted;
+    /** Number of messages lost because of CO_ERROR_RX_OVERFLOW */
+    uint16_t            rxOverflow;
+    /** Last block size used */
+    uint8_t             blksize;
+}CO_SDO_blockStats_t;
+
+
 /**
  * SDO server object.
  */
@@ -515,6 +570,25 @@ typedef struct{
     uint8_t             endOfTransfer;
     /** Variable indicates, if new SDO message received from CAN bus */
     uint8_t             CANrxNew;
+#if CO_SDO_FAST_UPLOAD == 1
+    /** True, if fast expedited upload is allowed (NMT state from the last
+    CO_SDO_process() call) */
+    uint8_t             fastUploadEnabled;
+    /** Index of the last object found by fast expedited upload */
+    uint16_t            fastIndex;
+    /** Sequence number of the OD entry with fastIndex */
+    uint16_t            fastEntryNo;
+#endif
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+    /** Adapted block size for block download, kept between transfers */
+    uint8_t             blksizeAdaptive;
+    /** Counter of messages lost in receive function because of overflow */
+    uint16_t            rxOverflowCnt;
+    /** Value of rxOverflowCnt at the start of the current block */
+    uint16_t            rxOverflowBlock;
+    /** Statistics of the last block transfer */
+    CO_SDO_blockStats_t blockStats;
+#endif
     /** From CO_SDO_init() */
     CO_CANmodule_t     *CANdevTx;
     /** CAN transmit buffer inside CANdev for CAN tx message */
@@ -723,5 +797,32 @@ uint32_t CO_SDO_readOD(CO_SDO_t *SDO, uint16_t SDOBufferSize);
 uint32_t CO_SDO_writeOD(CO_SDO_t *SDO, uint16_t length);
 
 
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+/**
+ * Calculate new block size for block transfer.
+ *
+ * Used by receiving side of the block transfer, SDO server or SDO client.
+ *
+ * @param blksize Current block size.
+ * @param blksizeMax Maximum allowed block size, 1 to 127.
+ * @param lost True, if last block was not received completely.
+ *
+ * @return Block size for the next block: half of the current on loss, else
+ * current incremented by one, limited to blksizeMax.
+ */
+uint8_t CO_SDO_blksizeAdapt(uint8_t blksize, uint8_t blksizeMax, uint8_t lost);
+
+
+/**
+ * Finish statistics of the block transfer.
+ *
+ * Calculates bytesPerSecond from bytes and time_ms.
+ *
+ * @param stats Statistics object.
+ */
+void CO_SDO_blockStatsEnd(CO_SDO_blockStats_t *stats);
+#endif
+
+
 /** @} */
 #endif
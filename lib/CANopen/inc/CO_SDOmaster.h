@@ -42,6 +42,34 @@
  */
 
 
+/**
+ * Default protocol switch threshold (pst) for SDO block upload, see
+ * CO_SDOclient_t.
+ */
+    #ifndef CO_SDO_CLIENT_PST
+        #define CO_SDO_CLIENT_PST               21
+    #endif
+
+
+/**
+ * Default maximum number of segments in one block for SDO block upload, see
+ * CO_SDOclient_t. If #CO_SDO_BLOCK_ADAPTIVE is enabled, this is the upper limit
+ * of the adapted block size.
+ */
+    #ifndef CO_SDO_CLIENT_BLOCK_SIZE_MAX
+        #define CO_SDO_CLIENT_BLOCK_SIZE_MAX    127
+    #endif
+
+
+/**
+ * Timeout for SDO client transfers in [milliseconds], used by CO_process()
+ * for @ref CO_SDOclientEngine.
+ */
+    #ifndef CO_SDO_CLIENT_TIMEOUT
+        #define CO_SDO_CLIENT_TIMEOUT           1000
+    #endif
+
+
 /**
  * SDO Client Parameter. The same as record from Object dictionary (index 0x1280+).
  */
@@ -109,6 +137,13 @@ typedef struct{
     void              (*pFunctSignal)(uint32_t arg);
     /** Optional argument, which is passed to above function */
     uint32_t            functArg;
+    /** Consumer of uploaded data in streaming upload, from
+    CO_SDOclientUploadInitiateStream(). NULL if not streaming. */
+    uint32_t          (*pFunctStream)(void *object, const uint8_t *data, uint32_t length);
+    /** Object passed to pFunctStream */
+    void               *streamObject;
+    /** CRC of data passed to pFunctStream, calculated incrementally */
+    uint16_t            streamCrc;
     /** From CO_SDOclient_init() */
     CO_CANmodule_t     *CANdevTx;
     /** CAN transmit buffer inside CANdevTx for CAN tx message */
@@ -131,6 +166,16 @@ typedef struct{
     uint8_t             block_noData;
     /** Server CRC support in block transfer */
     uint8_t             crcEnabled;
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+    /** Adapted block size for block upload, kept between transfers */
+    uint8_t             blksizeAdaptive;
+    /** Counter of messages lost in receive function because of overflow */
+    uint16_t            rxOverflowCnt;
+    /** Value of rxOverflowCnt at the start of the current block */
+    uint16_t            rxOverflowBlock;
+    /** Statistics of the last block transfer */
+    CO_SDO_blockStats_t blockStats;
+#endif
 
 }CO_SDOclient_t;
 
@@ -275,6 +320,44 @@ int8_t CO_SDOclientUploadInitiate(
         uint8_t                 blockEnable);
 
 
+/**
+ * Initiate streaming SDO upload communication.
+ *
+ * Same as CO_SDOclientUploadInitiate() with block transfer enabled, but
+ * object may be larger than buffer. Buffer holds only one block of
+ * segments. Received data are passed to consumer function after each
+ * block (and after each full buffer, if server switches to segmented
+ * transfer), so memory use does not depend on the object size. CRC of block
+ * transfer is calculated incrementally and verified at the end. Consumer may,
+ * for example, write data into file or into flash memory. Upload is then
+ * processed with CO_SDOclientUpload(), which returns total size of data.
+ *
+ * If object is read from own node, whole object must still fit into buffer.
+ *
+ * @param SDO_C This object.
+ * @param index Index of object in object dictionary in remote node.
+ * @param subIndex Subindex of object in object dictionary in remote node.
+ * @param buffer Pointer to data buffer for one block. Buffer must be valid
+ * until end of communication.
+ * @param bufferSize Size of buffer, at least 8. Block size is limited to
+ * (bufferSize-1)/7 segments.
+ * @param pFunctStream Consumer function, called from CO_SDOclientUpload() with
+ * next received data. It returns 0 or SDO abort code, which aborts the transfer.
+ * @param object Pointer to object, passed to pFunctStream. May be NULL.
+ *
+ * @return 0: Success.
+ * @return -2: Wrong arguments.
+ */
+int8_t CO_SDOclientUploadInitiateStream(
+        CO_SDOclient_t         *SDO_C,
+        uint16_t                index,
+        uint8_t                 subIndex,
+        uint8_t                *buffer,
+        uint32_t                bufferSize,
+        uint32_t              (*pFunctStream)(void *object, const uint8_t *data, uint32_t length),
+        void                   *object);
+
+
 /**
  * Process SDO upload communication.
  *
@@ -307,5 +390,173 @@ int8_t CO_SDOclientUpload(
         uint32_t               *pSDOabortCode);
 
 
+/**
+ * @defgroup CO_SDOclientEngine SDO client engine
+ * @{
+ *
+ * Queue of SDO client requests processed on multiple SDO client channels.
+ *
+ * Application prepares CO_SDOclientRequest_t objects and adds them into the
+ * queue with CO_SDOclientEngine_request(). CO_SDOclientEngine_process() takes
+ * requests from the queue in order, assigns them to free SDO client channels
+ * (index 0x1280+) and runs them until completion, when callback function is
+ * called. Transfers to different SDO servers run in parallel. Requests to the
+ * same SDO server are processed one after another, in the order of the queue,
+ * because SDO server can handle only one transfer at a time. If SDO server
+ * aborts block download initiate with 0x05040001 (command specifier not
+ * valid), download is repeated as segmented transfer.
+ *
+ * SDO client channels used by engine must not be used directly by application.
+ */
+
+
+/**
+ * One SDO client request, used by CO_SDOclientEngine_t.
+ *
+ * Object is defined by application and must be valid until callback is called.
+ */
+typedef struct CO_SDOclientRequest_t{
+    /** Node-ID of the SDO server, 1..127. */
+    uint8_t             nodeId;
+    /** Index of object in object dictionary in remote node. */
+    uint16_t            index;
+    /** Subindex of object in object dictionary in remote node. */
+    uint8_t             subIndex;
+    /** True for SDO upload (read), false for SDO download (write). */
+    uint8_t             upload;
+    /** Try to use block transfer. */
+    uint8_t             blockEnable;
+    /** Data buffer. By download it contains data to be written, by upload
+    data will be written into it. */
+    uint8_t            *buffer;
+    /** By download size of data in buffer, by upload size of buffer. */
+    uint32_t            bufferSize;
+    /** Callback function, called from CO_SDOclientEngine_process(), when
+    request is finished. May be NULL. Request may be added into queue again
+    from inside the callback. */
+    void              (*pFunct)(struct CO_SDOclientRequest_t *request);
+    /** Consumer for streaming upload, see CO_SDOclientUploadInitiateStream().
+    If not NULL, buffer holds only one block and object is passed to it.
+    Must be NULL for normal upload and for download. */
+    uint32_t          (*pFunctStream)(void *object, const uint8_t *data, uint32_t length);
+    /** Optional object, which can be used by the callback. */
+    void               *object;
+    /** Result: size of uploaded data. Written by engine. */
+    uint32_t            dataSize;
+    /** Result: SDO abort code or 0. Written by engine. */
+    uint32_t            abortCode;
+    /** Result: Last return value from CO_SDOclientDownload() or
+    CO_SDOclientUpload(), 0 on success. Written by engine. */
+    int8_t              result;
+    /** Internal, next request in queue. */
+    struct CO_SDOclientRequest_t *next;
+}CO_SDOclientRequest_t;
+
+
+/**
+ * SDO client engine object.
+ */
+typedef struct{
+    /** From CO_SDOclientEngine_init() */
+    CO_SDOclient_t    **SDOclients;
+    /** From CO_SDOclientEngine_init() */
+    uint8_t             numberOfClients;
+    /** Requests currently processed by the channel with the same index. Size of
+    array is equal to numberOfClients. */
+    CO_SDOclientRequest_t **active;
+    /** First request in queue, waiting for free channel. */
+    CO_SDOclientRequest_t *queueHead;
+    /** Last request in queue. */
+    CO_SDOclientRequest_t *queueTail;
+}CO_SDOclientEngine_t;
+
+
+/**
+ * Initialize SDO client engine.
+ *
+ * SDO client objects must be initialized before with CO_SDOclient_init().
+ *
+ * @param SDOCE This object will be initialized.
+ * @param SDOclients Array of pointers to SDO client objects (channels).
+ * @param active Pointer to the externaly defined array of the same size
+ * as numberOfClients.
+ * @param numberOfClients Size of the above arrays.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_SDOclientEngine_init(
+        CO_SDOclientEngine_t   *SDOCE,
+        CO_SDOclient_t        **SDOclients,
+        CO_SDOclientRequest_t **active,
+        uint8_t                 numberOfClients);
+
+
+/**
+ * Add request to the end of the queue.
+ *
+ * Request is started by CO_SDOclientEngine_process(). Function must not be
+ * called from interrupt.
+ *
+ * @param SDOCE This object.
+ * @param request Request, prepared by application.
+ *
+ * @return 0: Success.
+ * @return -2: Wrong arguments.
+ */
+int8_t CO_SDOclientEngine_request(
+        CO_SDOclientEngine_t   *SDOCE,
+        CO_SDOclientRequest_t  *request);
+
+
+/**
+ * Add Concise DCF download request to the end of the queue.
+ *
+ * Function fills the request for download of Concise DCF into object 0x1F22,
+ * sub-index nodeId, of the remote node, with block transfer enabled, and adds
+ * it into the queue with CO_SDOclientEngine_request(). Concise DCF can be built
+ * with CO_DCF_addEntry().
+ *
+ * @param SDOCE This object.
+ * @param request Request object, defined by application.
+ * @param nodeId Node-ID of the remote node.
+ * @param dcf Buffer with Concise DCF.
+ * @param dcfLength Length of Concise DCF in buffer.
+ * @param pFunct Callback function, may be NULL.
+ * @param object Object passed to callback, may be NULL.
+ *
+ * @return 0: Success.
+ * @return -2: Wrong arguments.
+ */
+int8_t CO_SDOclientEngine_DCF(
+        CO_SDOclientEngine_t   *SDOCE,
+        CO_SDOclientRequest_t  *request,
+        uint8_t                 nodeId,
+        uint8_t                *dcf,
+        uint32_t                dcfLength,
+        void                  (*pFunct)(CO_SDOclientRequest_t *request),
+        void                   *object);
+
+
+/**
+ * Process SDO client engine.
+ *
+ * Function must be called cyclically. It starts queued requests on free
+ * channels, processes all active transfers and calls callbacks of finished
+ * requests.
+ *
+ * @param SDOCE This object.
+ * @param timeDifference_ms Time difference from previous function call in [milliseconds].
+ * @param SDOtimeoutTime Timeout time for SDO communication in milliseconds.
+ *
+ * @return Number of requests, which are active or waiting in queue.
+ */
+uint16_t CO_SDOclientEngine_process(
+        CO_SDOclientEngine_t   *SDOCE,
+        uint16_t                timeDifference_ms,
+        uint16_t                SDOtimeoutTime);
+
+/** @} */
+
+
 /** @} */
 #endif
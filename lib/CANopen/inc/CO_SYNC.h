@@ -46,9 +46,52 @@
  * By default SYNC message has no data. If _Synchronous counter overflow value_
  * from Object dictionary (index 0x1019) is different than 0, SYNC message has
  * one data byte: counter incremented by 1 with every SYNC transmission.
+ *
+ * ####Timer driven SYNC producer
+ * By default SYNC producer is processed inside CO_SYNC_process(), so SYNC
+ * period jitters by the period of its call. If #CO_SYNC_TIMER_PRODUCER is
+ * set to 1, SYNC message is transmitted by CO_SYNC_timerISR(), which must be
+ * called from the compare interrupt of a hardware timer, running with period
+ * equal to CO_SYNC_t::periodTime. Message is copied directly into the CAN
+ * transmit mailbox reserved for it, see CO_CANsendReserved().
+ *
+ * ####SYNC period jitter
+ * If CO_SYNC_initJitter() is called, the time between two consecutive SYNC
+ * messages (received or transmitted) is measured with CO_timer.h and
+ * statistics are written into array of UNSIGNED32 from Object dictionary:
+ *  - element 0: Number of measured periods.
+ *  - element 1: Minimum period in [microseconds].
+ *  - element 2: Maximum period in [microseconds].
+ *  - element 3 and above: Histogram of absolute difference between measured
+ *    period and CO_SYNC_t::periodTime. Width of each histogram bin is
+ *    #CO_SYNC_JITTER_BIN_WIDTH, the last bin also counts all larger values.
+ *    Histogram is not updated, if _Communication cycle period_ is zero.
+ *
+ * Writing to any element of the array clears the statistics.
  */
 
 
+/**
+ * SYNC producer mode.
+ *
+ * If set to 1, SYNC producer is not processed in CO_SYNC_process(), but
+ * CO_SYNC_timerISR() must be called from a hardware timer interrupt. One
+ * CAN transmit mailbox is reserved for the SYNC message, if device is SYNC
+ * producer.
+ */
+    #ifndef CO_SYNC_TIMER_PRODUCER
+        #define CO_SYNC_TIMER_PRODUCER      0
+    #endif
+
+
+/**
+ * Width of one bin in the SYNC period jitter histogram in [microseconds].
+ */
+    #ifndef CO_SYNC_JITTER_BIN_WIDTH
+        #define CO_SYNC_JITTER_BIN_WIDTH    10
+    #endif
+
+
 /**
  * SYNC producer and consumer object.
  */
@@ -75,11 +118,23 @@ typedef struct{
     uint8_t             curentSyncTimeIsInsideWindow;
     /** True in operational, after first SYNC was received or transmitted */
     uint32_t            running;
+    /** Set after SYNC message was received or transmitted, cleared by
+    CO_SYNC_process(), so no SYNC is missed between two calls. */
+    volatile uint8_t    SYNCnew;
     /** Timer for the SYNC message in [microseconds].
     Set to zero after received or transmitted SYNC message */
     uint32_t            timer;
     /** Counter of the SYNC message if counterOverflowValue is different than zero */
     uint8_t             counter;
+    /** SYNC period jitter statistics from CO_SYNC_initJitter() or NULL */
+    uint32_t           *jitter;
+    /** Number of elements in the above array */
+    uint8_t             jitterSize;
+    /** True, if timestamp holds time of the previous SYNC message */
+    uint8_t             jitterTimerValid;
+    /** Time of the last received or transmitted SYNC message, taken with
+    CO_timer.h. May be used for measuring time since SYNC. */
+    ttimer              timestamp;
     CO_CANmodule_t     *CANdevRx;       /**< From CO_SYNC_init() */
     uint16_t            CANdevRxIdx;    /**< From CO_SYNC_init() */
     CO_CANmodule_t     *CANdevTx;       /**< From CO_SYNC_init() */
@@ -121,6 +176,48 @@ int16_t CO_SYNC_init(
         uint16_t                CANdevTxIdx);
 
 
+/**
+ * Initialize SYNC period jitter statistics.
+ *
+ * Function may be called in the communication reset section after
+ * CO_SYNC_init(). Statistics are cleared. CO_timer.h must be initialized
+ * with initTimer().
+ *
+ * @param SYNC This object.
+ * @param SDO SDO server object.
+ * @param jitter Pointer to array of UNSIGNED32 from Object dictionary, see
+ * description of the @ref CO_SYNC.
+ * @param jitterSize Number of elements in the above array, at least 4.
+ * @param index Index of the above array in Object dictionary.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_SYNC_initJitter(
+        CO_SYNC_t              *SYNC,
+        CO_SDO_t               *SDO,
+        uint32_t               *jitter,
+        uint8_t                 jitterSize,
+        uint16_t                index);
+
+
+#if CO_SYNC_TIMER_PRODUCER == 1
+/**
+ * Transmit SYNC message, if device is SYNC producer.
+ *
+ * Function must be called from the compare interrupt of a hardware timer,
+ * with period equal to CO_SYNC_t::periodTime. Used only, if
+ * #CO_SYNC_TIMER_PRODUCER is set to 1.
+ *
+ * @param SYNC This object.
+ *
+ * @return 0: SYNC message was not transmitted, also if reserved mailbox was
+ * still busy. Counter and timer are then not changed.
+ * @return 1: SYNC message was just transmitted.
+ */
+uint8_t CO_SYNC_timerISR(CO_SYNC_t *SYNC);
+#endif
+
+
 /**
  * Process SYNC communication.
  *
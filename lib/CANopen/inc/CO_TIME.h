@@ -0,0 +1,234 @@
+/**
+ * CANopen TIME object.
+ *
+ * @file        CO_TIME.h
+ * @ingroup     CO_TIME
+ * @version     SVN: \$Id: CO_TIME.h 32 2013-03-11 08:24:27Z jani22 $
+ * @author      Janez Paternoster
+ * @copyright   2013 Janez Paternoster
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _CO_TIME_H
+#define _CO_TIME_H
+
+
+/**
+ * @defgroup CO_TIME TIME
+ * @ingroup CO_CANopen
+ * @{
+ *
+ * CANopen TIME object protocol (index 0x1012).
+ *
+ * TIME message is used for distribution of the time of day over the network.
+ * There is one TIME producer and zero or more TIME consumers. Time of day is
+ * kept by the disciplined clock from CO_timer.h: TIME consumer sets it with
+ * setTimeOfDay() from received messages and the application reads it with
+ * getTimeOfDay(getTimeNow_us(), &tod). On TIME producer the application sets
+ * the clock from its own time source (RTC, GPS, ...) and CO_TIME_process()
+ * transmits TIME message every CO_TIME_t::periodTime.
+ *
+ * ####Contents of TIME message (TIME_OF_DAY, 6 bytes, little-endian)
+ *
+ *   Bytes | Description
+ *   ------|-----------------------------------------------------------
+ *     4   | Milliseconds after midnight (bits 0..27, bits 28..31 are 0).
+ *     2   | Days since January 1, 1984.
+ *
+ * ####Follow-up message
+ * Consumer takes the time of reception of the TIME message with
+ * getTimeNow_us() inside the CAN receive interrupt. Producer can not know the
+ * exact time of transmission, when it writes the message, because message
+ * may wait for the CAN mailbox and for the bus. If #CO_TIME_FOLLOW_UP is set
+ * to 1, producer records the time, when TIME message was handed off to the
+ * CAN mailbox, and sends the follow-up message with 8 data bytes:
+ * TIME_OF_DAY at the hand-off (6 bytes) and microseconds (2 bytes). Consumer
+ * applies the follow-up message to the reception time of the preceding TIME
+ * message, so time of day is corrected for the transmission delay of the
+ * producer. Consumer sets the clock from the TIME message itself, if no
+ * follow-up message was received for #CO_TIME_FOLLOW_UP_TIMEOUT, so it also
+ * works with a producer, which does not send follow-up messages.
+ *
+ * Follow-up message is not part of CiA 301. It uses its own identifier, given
+ * to CO_TIME_initFollowUp(), so TIME message itself is unchanged. Identifier
+ * must not be used by any other device in the network and must not be inside
+ * CAN identifier ranges restricted by CiA 301.
+ */
+
+
+/**
+ * Transmission of the follow-up message by TIME producer and its use by
+ * TIME consumer, see @ref CO_TIME.
+ */
+    #ifndef CO_TIME_FOLLOW_UP
+        #define CO_TIME_FOLLOW_UP           0
+    #endif
+
+
+/**
+ * CAN identifier of the follow-up message, used by CO_init(), see
+ * @ref CO_TIME. Default is outside of the ranges restricted by CiA 301 and
+ * outside of the predefined connection set.
+ */
+    #ifndef CO_TIME_FOLLOW_UP_COB_ID
+        #define CO_TIME_FOLLOW_UP_COB_ID    0x680
+    #endif
+
+
+/**
+ * Time in [milliseconds] after the last received follow-up message, after
+ * which TIME consumer sets the clock from TIME messages again. Must be longer
+ * than the TIME period of the producer.
+ */
+    #ifndef CO_TIME_FOLLOW_UP_TIMEOUT
+        #define CO_TIME_FOLLOW_UP_TIMEOUT   3000
+    #endif
+
+
+/**
+ * TIME producer and consumer object.
+ */
+typedef struct{
+    CO_EM_t            *EM;             /**< From CO_TIME_init() */
+    uint8_t            *operatingState; /**< From CO_TIME_init() */
+    /** True, if device is TIME consumer. Calculated from _COB ID TIME_
+    variable from Object dictionary (index 0x1012). */
+    uint8_t             isConsumer;
+    /** True, if device is TIME producer. Calculated from _COB ID TIME_
+    variable from Object dictionary (index 0x1012). */
+    uint8_t             isProducer;
+    /** COB_ID of TIME message. Calculated from _COB ID TIME_ variable from
+    Object dictionary (index 0x1012). */
+    uint16_t            COB_ID;
+    /** TIME producer period in [milliseconds], from CO_TIME_init() */
+    uint16_t            periodTime;
+    /** Timer for the TIME producer in [milliseconds] */
+    uint16_t            timer;
+    /** Variable indicates, if new TIME message received from CAN bus */
+    volatile uint8_t    CANrxNew;
+    /** Received TIME_OF_DAY */
+    uint8_t             CANrxData[6];
+    /** Local time of reception of the last TIME message, from getTimeNow_us() */
+    uint32_t            rxTimestamp;
+#if CO_TIME_FOLLOW_UP == 1
+    /** Variable indicates, if new follow-up message received from CAN bus */
+    volatile uint8_t    CANrxFollowUpNew;
+    /** Received follow-up message */
+    uint8_t             CANrxFollowUpData[8];
+    /** Reception time of the TIME message, to which follow-up belongs */
+    uint32_t            rxFollowUpTimestamp;
+    /** Time since the last received follow-up message in [milliseconds],
+    limited to #CO_TIME_FOLLOW_UP_TIMEOUT */
+    uint16_t            rxFollowUpTimer;
+    /** Producer state: 0 = idle, 1 = TIME message waits for CAN mailbox,
+    2 = TIME message handed off, follow-up message must be sent. */
+    volatile uint8_t    txState;
+    /** Local time, when TIME message was handed off to the CAN mailbox */
+    uint32_t            txTimestamp;
+    /** CAN transmit buffer for follow-up message from CO_TIME_initFollowUp()
+    or NULL */
+    CO_CANtx_t         *CANtxFollowUp;
+#endif
+    CO_CANmodule_t     *CANdevRx;       /**< From CO_TIME_init() */
+    uint16_t            CANdevRxIdx;    /**< From CO_TIME_init() */
+    CO_CANmodule_t     *CANdevTx;       /**< From CO_TIME_init() */
+    CO_CANtx_t         *CANtxBuff;      /**< CAN transmit buffer inside CANdevTx */
+    uint16_t            CANdevTxIdx;    /**< From CO_TIME_init() */
+}CO_TIME_t;
+
+
+/**
+ * Initialize TIME object.
+ *
+ * Function must be called in the communication reset section. CO_timer.h
+ * must be initialized with initTimer().
+ *
+ * @param TIME This object will be initialized.
+ * @param EM Emergency object.
+ * @param SDO SDO server object.
+ * @param operatingState Pointer to variable indicating CANopen device NMT internal state.
+ * @param COB_ID_TIMEMessage From Object dictionary (index 0x1012).
+ * @param periodTime TIME producer period in [milliseconds], 0 disables producer.
+ * @param CANdevRx CAN device for TIME reception.
+ * @param CANdevRxIdx Index of receive buffer in the above CAN device.
+ * @param CANdevTx CAN device for TIME transmission.
+ * @param CANdevTxIdx Index of transmit buffer in the above CAN device.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_TIME_init(
+        CO_TIME_t              *TIME,
+        CO_EM_t                *EM,
+        CO_SDO_t               *SDO,
+        uint8_t                *operatingState,
+        uint32_t                COB_ID_TIMEMessage,
+        uint16_t                periodTime,
+        CO_CANmodule_t         *CANdevRx,
+        uint16_t                CANdevRxIdx,
+        CO_CANmodule_t         *CANdevTx,
+        uint16_t                CANdevTxIdx);
+
+
+#if CO_TIME_FOLLOW_UP == 1
+/**
+ * Initialize follow-up message of TIME object.
+ *
+ * Function must be called in the communication reset section after
+ * CO_TIME_init(). It configures reception and transmission of the follow-up
+ * message. Follow-up message is transmitted only, if device is TIME producer.
+ *
+ * @param TIME This object.
+ * @param COB_ID_followUp CAN identifier of the follow-up message, for example
+ * #CO_TIME_FOLLOW_UP_COB_ID. Identifiers restricted by CiA 301 and identifier
+ * of the TIME message are not accepted.
+ * @param CANdevRx CAN device for follow-up reception.
+ * @param CANdevRxIdx Index of receive buffer in the above CAN device.
+ * @param CANdevTxIdx Index of transmit buffer in CAN device for TIME
+ * transmission, from CO_TIME_init().
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+int16_t CO_TIME_initFollowUp(
+        CO_TIME_t              *TIME,
+        uint16_t                COB_ID_followUp,
+        CO_CANmodule_t         *CANdevRx,
+        uint16_t                CANdevRxIdx,
+        uint16_t                CANdevTxIdx);
+#endif
+
+
+/**
+ * Process TIME communication.
+ *
+ * Function must be called cyclically.
+ *
+ * @param TIME This object.
+ * @param timeDifference_ms Time difference from previous function call in [milliseconds].
+ *
+ * @return 0: No special meaning.
+ * @return 1: Time of day was just set from received TIME message.
+ */
+uint8_t CO_TIME_process(
+        CO_TIME_t              *TIME,
+        uint16_t                timeDifference_ms);
+
+
+/** @} */
+#endif
@@ -19,5 +19,28 @@ int initTimer(pf_getTimerVal_us gett);
 void saveTime(ttimer *tim);
 uint32_t getTime_ms(ttimer *tim);
 uint32_t getTime_us(ttimer *tim);
+uint32_t getTimeNow_us(void);
+
+/* Time of day, as in CANopen TIME_OF_DAY, with microsecond resolution */
+typedef struct {
+	uint32_t ms;	/* milliseconds after midnight */
+	uint16_t days;	/* days since January 1, 1984 */
+	uint16_t us;	/* microseconds, 0..999 */
+} ttimeOfDay;
+
+/*
+ * Disciplined time of day clock, driven by the free running timer.
+ *
+ * setTimeOfDay() tells the clock, which time of day corresponds to the local
+ * timer value localTime_us (for example RX timestamp of the TIME message).
+ * First call or error larger than one second steps the clock, smaller errors
+ * also adjust the rate of the clock, so it follows the time master between
+ * updates. getTimeOfDay() returns time of day at local timer value
+ * localTime_us, usually getTimeNow_us(). It returns -1, if clock was never set.
+ * Clock must be set or read at least once every 30 minutes.
+ */
+int setTimeOfDay(uint32_t localTime_us, const ttimeOfDay *tod);
+int getTimeOfDay(uint32_t localTime_us, ttimeOfDay *tod);
+int32_t getTimeOfDayRate_ppm(void);
 
 #endif /* TIMER_H_ */
@@ -44,6 +44,18 @@
 #define ENABLE_INTERRUPTS()         __set_PRIMASK(0);
 
 
+/* Atomic operations, safe between interrupts of any priority (LDREX/STREX).
+ * Read-modify-write macros return the previous value. */
+#define CO_ATOMIC_FETCH_OR(ptr, val)    __atomic_fetch_or((ptr), (val), __ATOMIC_SEQ_CST)
+#define CO_ATOMIC_FETCH_AND(ptr, val)   __atomic_fetch_and((ptr), (val), __ATOMIC_SEQ_CST)
+#define CO_ATOMIC_FETCH_ADD(ptr, val)   __atomic_fetch_add((ptr), (val), __ATOMIC_SEQ_CST)
+#define CO_ATOMIC_EXCHANGE(ptr, val)    __atomic_exchange_n((ptr), (val), __ATOMIC_SEQ_CST)
+/* If *ptr equals *pExpected, write desired and return true. Otherwise copy *ptr into *pExpected. */
+#define CO_ATOMIC_CAS(ptr, pExpected, desired) \
+        __atomic_compare_exchange_n((ptr), (pExpected), (desired), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+#define CO_MEMORY_BARRIER()             __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+
 /* Data types */
     typedef unsigned char           uint8_t;
     typedef unsigned short int      uint16_t;
@@ -111,6 +123,11 @@ typedef struct{
     uint8_t             data[8];
     volatile uint8_t    bufferFull;
     volatile uint8_t    syncFlag;
+    /* Optional, called when message is copied to CAN mailbox (dropped = 0) or
+     * when synchronous message is dropped outside SYNC window (dropped = 1).
+     * Not changed by CO_CANtxBufferInit(). */
+    void               *object;
+    void              (*pFunctHandOff)(void *object, uint8_t dropped);
 }CO_CANtx_t;/* ALIGN_STRUCT_DWORD; */
 
 
@@ -129,6 +146,7 @@ typedef struct{
     uint32_t            errOld;
     void               *EM;
     uint8_t             transmittingAborted;    /* STM32F4xx specific */
+    volatile uint8_t    txMailboxReserved;      /* STM32F4xx specific, see CO_CANsendReserved() */
 }CO_CANmodule_t;
 
 
@@ -202,6 +220,16 @@ CO_CANtx_t *CO_CANtxBufferInit(
 int16_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer);
 
 
+/* Send CAN message through the transmit mailbox reserved for time critical
+ * messages (CO_CAN_TX_MAILBOX_RESERVED). Mailbox is reserved, if
+ * txMailboxReserved is set, and is then not used by CO_CANsend(). Message is
+ * copied to the mailbox immediately, so function may be called from interrupt
+ * of a hardware timer. If mailbox is still busy, CO_ERROR_TX_OVERFLOW is
+ * returned. If mailbox is not reserved, CO_CANsend() is used. */
+#define CO_CAN_TX_MAILBOX_RESERVED  CAN_TXMAILBOX_2
+int16_t CO_CANsendReserved(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer);
+
+
 /* Clear all synchronous TPDOs from CAN module transmit buffers. */
 void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule);
 
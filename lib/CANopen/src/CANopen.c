@@ -60,22 +60,43 @@
   #endif
     static CO_OD_extension_t   *CO_SDO_ODExtensions;
     static CO_HBconsNode_t     *CO_HBcons_monitoredNodes;
+#if CO_NO_EM_CONS > 0
+    static CO_EMconsNode_t     *CO_EMcons_nodes;
+#endif
+#if CO_NO_SDO_CLIENT > 0
+    static CO_SDOclientRequest_t **CO_SDOclientEngine_active;
+#endif
 
 
 /* Verify features from CO_OD *************************************************/
     /* generate error, if features are not corectly configured for this project */
     #if        CO_NO_NMT_MASTER                           >  1     \
             || CO_NO_SYNC                                 != 1     \
+            || CO_NO_TIME                                 >  1     \
             || CO_NO_EMERGENCY                            != 1     \
+            || CO_NO_EM_CONS                              >  1     \
             || CO_NO_SDO_SERVER                           != 1     \
-            || (CO_NO_SDO_CLIENT != 0 && CO_NO_SDO_CLIENT != 1)    \
+            || (CO_NO_SDO_CLIENT < 0 || CO_NO_SDO_CLIENT > 128)     \
             || (CO_NO_RPDO < 1 || CO_NO_RPDO > 0x200)              \
             || (CO_NO_TPDO < 1 || CO_NO_TPDO > 0x200)              \
             || ODL_consumerHeartbeatTime_arrayLength      == 0     \
+            || ODL_consumerHeartbeatTime_arrayLength      > 127    \
             || ODL_errorStatusBits_stringLength           < 10
         #error Features from CO_OD.h file are not corectly configured for this project!
     #endif
 
+    /* SYNC to TPDO latency (0x2110+) and RPDO statistics (0x2118+) use one
+     * object per PDO and have room for 4 PDOs. They are optional, remove them
+     * from CO_OD.h for more PDOs. Arrays 0x2114..0x2116 have one subindex per
+     * TPDO. */
+    #if    (defined ODL_TPDOSYNCLatency_arrayLength && CO_NO_TPDO > 4)     \
+        || (defined ODL_RPDOStatistics_arrayLength && CO_NO_RPDO > 4)      \
+        || ODL_TPDOSYNCOffset_arrayLength             < CO_NO_TPDO         \
+        || ODL_TPDOEventTimeUs_arrayLength            < CO_NO_TPDO         \
+        || ODL_TPDOGroup_arrayLength                  < CO_NO_TPDO
+        #error PDO objects from CO_OD.h file do not match the number of PDOs!
+    #endif
+
 
 /* Indexes for CANopenNode message objects ************************************/
     #ifdef ODL_consumerHeartbeatTime_arrayLength
@@ -83,25 +104,50 @@
     #else
         #define CO_NO_HB_CONS   0
     #endif
+    #ifndef CO_NO_TIME
+        #define CO_NO_TIME      0
+    #endif
+    #ifndef CO_NO_EM_CONS
+        #define CO_NO_EM_CONS   0
+    #endif
+    /* number of first TPDOs, which respond to RTR, see CO_TPDO_initRTR() */
+    #ifndef CO_NO_TPDO_RTR
+        #define CO_NO_TPDO_RTR  0
+    #endif
+    #if CO_NO_TPDO_RTR > CO_NO_TPDO
+        #error CO_NO_TPDO_RTR is larger than number of TPDOs!
+    #endif
+    #if CO_NO_TIME > 0 && CO_TIME_FOLLOW_UP == 1
+        #define CO_NO_TIME_FU   1
+    #else
+        #define CO_NO_TIME_FU   0
+    #endif
 
     #define CO_RXCAN_NMT       0                                      /*  index for NMT message */
     #define CO_RXCAN_SYNC      1                                      /*  index for SYNC message */
-    #define CO_RXCAN_RPDO     (CO_RXCAN_SYNC+CO_NO_SYNC)              /*  start index for RPDO messages */
+    #define CO_RXCAN_TIME     (CO_RXCAN_SYNC+CO_NO_SYNC)              /*  index for TIME message */
+    #define CO_RXCAN_TIME_FU  (CO_RXCAN_TIME+CO_NO_TIME)              /*  index for TIME follow-up message */
+    #define CO_RXCAN_RPDO     (CO_RXCAN_TIME_FU+CO_NO_TIME_FU)        /*  start index for RPDO messages */
     #define CO_RXCAN_SDO_SRV  (CO_RXCAN_RPDO+CO_NO_RPDO)              /*  start index for SDO server message (request) */
     #define CO_RXCAN_SDO_CLI  (CO_RXCAN_SDO_SRV+CO_NO_SDO_SERVER)     /*  start index for SDO client message (response) */
-    #define CO_RXCAN_CONS_HB  (CO_RXCAN_SDO_CLI+CO_NO_SDO_CLIENT)     /*  start index for Heartbeat Consumer messages */
+    #define CO_RXCAN_CONS_HB  (CO_RXCAN_SDO_CLI+CO_NO_SDO_CLIENT)     /*  index for Heartbeat Consumer messages, one for all nodes */
+    #define CO_RXCAN_EM_CONS  (CO_RXCAN_CONS_HB+1)                    /*  index for Emergency consumer messages, after heartbeat consumer (SYNC has lower index) */
+    #define CO_RXCAN_TPDO_RTR (CO_RXCAN_EM_CONS+CO_NO_EM_CONS)        /*  start index for TPDO remote transmission requests */
+    #define CO_RXCAN_TPDO_MON (CO_RXCAN_TPDO_RTR+CO_NO_TPDO_RTR)      /*  index for TPDO monitor, accepts all other messages, must be last */
     /* total number of received CAN messages */
-    #define CO_RXCAN_NO_MSGS (1+CO_NO_SYNC+CO_NO_RPDO+CO_NO_SDO_SERVER+CO_NO_SDO_CLIENT+CO_NO_HB_CONS)
+    #define CO_RXCAN_NO_MSGS (1+CO_NO_SYNC+CO_NO_TIME+CO_NO_TIME_FU+CO_NO_RPDO+CO_NO_SDO_SERVER+CO_NO_SDO_CLIENT+1+CO_NO_EM_CONS+CO_NO_TPDO_RTR+1)
 
     #define CO_TXCAN_NMT       0                                      /*  index for NMT master message */
     #define CO_TXCAN_SYNC      CO_TXCAN_NMT+CO_NO_NMT_MASTER          /*  index for SYNC message */
     #define CO_TXCAN_EMERG    (CO_TXCAN_SYNC+CO_NO_SYNC)              /*  index for Emergency message */
-    #define CO_TXCAN_TPDO     (CO_TXCAN_EMERG+CO_NO_EMERGENCY)        /*  start index for TPDO messages */
+    #define CO_TXCAN_TIME     (CO_TXCAN_EMERG+CO_NO_EMERGENCY)        /*  index for TIME message */
+    #define CO_TXCAN_TIME_FU  (CO_TXCAN_TIME+CO_NO_TIME)              /*  index for TIME follow-up message */
+    #define CO_TXCAN_TPDO     (CO_TXCAN_TIME_FU+CO_NO_TIME_FU)        /*  start index for TPDO messages */
     #define CO_TXCAN_SDO_SRV  (CO_TXCAN_TPDO+CO_NO_TPDO)              /*  start index for SDO server message (response) */
     #define CO_TXCAN_SDO_CLI  (CO_TXCAN_SDO_SRV+CO_NO_SDO_SERVER)     /*  start index for SDO client message (request) */
     #define CO_TXCAN_HB       (CO_TXCAN_SDO_CLI+CO_NO_SDO_CLIENT)     /*  index for Heartbeat message */
     /* total number of transmitted CAN messages */
-    #define CO_TXCAN_NO_MSGS (CO_NO_NMT_MASTER+CO_NO_SYNC+CO_NO_EMERGENCY+CO_NO_TPDO+CO_NO_SDO_SERVER+CO_NO_SDO_CLIENT+1)
+    #define CO_TXCAN_NO_MSGS (CO_NO_NMT_MASTER+CO_NO_SYNC+CO_NO_EMERGENCY+CO_NO_TIME+CO_NO_TIME_FU+CO_NO_TPDO+CO_NO_SDO_SERVER+CO_NO_SDO_CLIENT+1)
 
 
 #ifdef CO_USE_GLOBALS
@@ -118,16 +164,33 @@
     static CO_EMpr_t            COO_EMpr;
     static CO_NMT_t             COO_NMT;
     static CO_SYNC_t            COO_SYNC;
+#if CO_NO_TIME > 0
+    static CO_TIME_t            COO_TIME;
+#endif
     static CO_RPDO_t            COO_RPDO[CO_NO_RPDO];
     static CO_TPDO_t            COO_TPDO[CO_NO_TPDO];
+    static CO_TPDOmonitor_t     COO_TPDOmon;
     static CO_HBconsumer_t      COO_HBcons;
+    static CO_NMTevents_t       COO_NMTevents;
     static CO_HBconsNode_t      COO_HBcons_monitoredNodes[CO_NO_HB_CONS];
-#if CO_NO_SDO_CLIENT == 1
-    static CO_SDOclient_t       COO_SDOclient;
+#if CO_NO_EM_CONS > 0
+    static CO_EMcons_t          COO_EMcons;
+    static CO_EMconsNode_t      COO_EMcons_nodes[ODL_emergencyConsumer_arrayLength];
+#endif
+    static CO_DCF_t             COO_DCF;
+#if CO_NO_SDO_CLIENT > 0
+    static CO_SDOclient_t       COO_SDOclient[CO_NO_SDO_CLIENT];
+    static CO_SDOclientEngine_t COO_SDOclientEngine;
+    static CO_SDOclientRequest_t *COO_SDOclientEngine_active[CO_NO_SDO_CLIENT];
 #endif
 #endif
 
 
+/* True after SYNC was received or transmitted, until synchronous TPDOs are
+ * processed in CO_process_TPDO() */
+static uint8_t CO_SYNCnew = 0;
+
+
 /******************************************************************************/
 #if CO_NO_NMT_MASTER == 1
     CO_CANtx_t *NMTM_txBuff = 0;
@@ -203,7 +266,7 @@ int16_t CO_init(){
         return CO_ERROR_PARAMETERS;
     }
 
-    #if CO_NO_SDO_CLIENT == 1
+    #if CO_NO_SDO_CLIENT > 0
     if(sizeof(OD_SDOClientParameter_t) != sizeof(CO_SDOclientPar_t)){
         return CO_ERROR_PARAMETERS;
     }
@@ -227,14 +290,27 @@ int16_t CO_init(){
     CO->EMpr                            = &COO_EMpr;
     CO->NMT                             = &COO_NMT;
     CO->SYNC                            = &COO_SYNC;
+    #if CO_NO_TIME > 0
+    CO->TIME                            = &COO_TIME;
+    #endif
     for(i=0; i<CO_NO_RPDO; i++)
         CO->RPDO[i]                     = &COO_RPDO[i];
     for(i=0; i<CO_NO_TPDO; i++)
         CO->TPDO[i]                     = &COO_TPDO[i];
+    CO->TPDOmon                         = &COO_TPDOmon;
     CO->HBcons                          = &COO_HBcons;
+    CO->NMTevents                       = &COO_NMTevents;
     CO_HBcons_monitoredNodes            = &COO_HBcons_monitoredNodes[0];
-    #if CO_NO_SDO_CLIENT == 1
-    CO->SDOclient                       = &COO_SDOclient;
+    #if CO_NO_EM_CONS > 0
+    CO->EMcons                          = &COO_EMcons;
+    CO_EMcons_nodes                     = &COO_EMcons_nodes[0];
+    #endif
+    CO->DCF                             = &COO_DCF;
+    #if CO_NO_SDO_CLIENT > 0
+    for(i=0; i<CO_NO_SDO_CLIENT; i++)
+        CO->SDOclient[i]                = &COO_SDOclient[i];
+    CO->SDOclientEngine                 = &COO_SDOclientEngine;
+    CO_SDOclientEngine_active           = &COO_SDOclientEngine_active[0];
     #endif
 #else
     CO->CANmodule[0]                    = (CO_CANmodule_t *)    malloc(sizeof(CO_CANmodule_t));
@@ -251,16 +327,30 @@ int16_t CO_init(){
     CO->EMpr                            = (CO_EMpr_t *)         malloc(sizeof(CO_EMpr_t));
     CO->NMT                             = (CO_NMT_t *)          malloc(sizeof(CO_NMT_t));
     CO->SYNC                            = (CO_SYNC_t *)         malloc(sizeof(CO_SYNC_t));
+    #if CO_NO_TIME > 0
+    CO->TIME                            = (CO_TIME_t *)         malloc(sizeof(CO_TIME_t));
+    #endif
     for(i=0; i<CO_NO_RPDO; i++){
         CO->RPDO[i]                     = (CO_RPDO_t *)         malloc(sizeof(CO_RPDO_t));
     }
     for(i=0; i<CO_NO_TPDO; i++){
         CO->TPDO[i]                     = (CO_TPDO_t *)         malloc(sizeof(CO_TPDO_t));
     }
+    CO->TPDOmon                         = (CO_TPDOmonitor_t *)  malloc(sizeof(CO_TPDOmonitor_t));
     CO->HBcons                          = (CO_HBconsumer_t *)   malloc(sizeof(CO_HBconsumer_t));
+    CO->NMTevents                       = (CO_NMTevents_t *)    malloc(sizeof(CO_NMTevents_t));
     CO_HBcons_monitoredNodes            = (CO_HBconsNode_t *)   malloc(sizeof(CO_HBconsNode_t) * CO_NO_HB_CONS);
-    #if CO_NO_SDO_CLIENT == 1
-    CO->SDOclient                       = (CO_SDOclient_t *)    malloc(sizeof(CO_SDOclient_t));
+    #if CO_NO_EM_CONS > 0
+    CO->EMcons                          = (CO_EMcons_t *)       malloc(sizeof(CO_EMcons_t));
+    CO_EMcons_nodes                     = (CO_EMconsNode_t *)   malloc(sizeof(CO_EMconsNode_t) * ODL_emergencyConsumer_arrayLength);
+    #endif
+    CO->DCF                             = (CO_DCF_t *)          malloc(sizeof(CO_DCF_t));
+    #if CO_NO_SDO_CLIENT > 0
+    for(i=0; i<CO_NO_SDO_CLIENT; i++){
+        CO->SDOclient[i]                = (CO_SDOclient_t *)    malloc(sizeof(CO_SDOclient_t));
+    }
+    CO->SDOclientEngine                 = (CO_SDOclientEngine_t *) malloc(sizeof(CO_SDOclientEngine_t));
+    CO_SDOclientEngine_active           = (CO_SDOclientRequest_t **) malloc(sizeof(CO_SDOclientRequest_t *) * CO_NO_SDO_CLIENT);
     #endif
 
     CO_memoryUsed = sizeof(CO_CANmodule_t)
@@ -277,12 +367,24 @@ int16_t CO_init(){
                   + sizeof(CO_EMpr_t)
                   + sizeof(CO_NMT_t)
                   + sizeof(CO_SYNC_t)
+    #if CO_NO_TIME > 0
+                  + sizeof(CO_TIME_t)
+    #endif
                   + sizeof(CO_RPDO_t) * CO_NO_RPDO
                   + sizeof(CO_TPDO_t) * CO_NO_TPDO
+                  + sizeof(CO_TPDOmonitor_t)
                   + sizeof(CO_HBconsumer_t)
+                  + sizeof(CO_NMTevents_t)
                   + sizeof(CO_HBconsNode_t) * CO_NO_HB_CONS
-    #if CO_NO_SDO_CLIENT == 1
-                  + sizeof(CO_SDOclient_t)
+    #if CO_NO_EM_CONS > 0
+                  + sizeof(CO_EMcons_t)
+                  + sizeof(CO_EMconsNode_t) * ODL_emergencyConsumer_arrayLength
+    #endif
+                  + sizeof(CO_DCF_t)
+    #if CO_NO_SDO_CLIENT > 0
+                  + sizeof(CO_SDOclient_t) * CO_NO_SDO_CLIENT
+                  + sizeof(CO_SDOclientEngine_t)
+                  + sizeof(CO_SDOclientRequest_t *) * CO_NO_SDO_CLIENT
     #endif
                   + 0;
 
@@ -301,16 +403,30 @@ int16_t CO_init(){
     if(CO->EMpr                         == NULL) errCnt++;
     if(CO->NMT                          == NULL) errCnt++;
     if(CO->SYNC                         == NULL) errCnt++;
+  #if CO_NO_TIME > 0
+    if(CO->TIME                         == NULL) errCnt++;
+  #endif
     for(i=0; i<CO_NO_RPDO; i++){
         if(CO->RPDO[i]                  == NULL) errCnt++;
     }
     for(i=0; i<CO_NO_TPDO; i++){
         if(CO->TPDO[i]                  == NULL) errCnt++;
     }
+    if(CO->TPDOmon                      == NULL) errCnt++;
     if(CO->HBcons                       == NULL) errCnt++;
+    if(CO->NMTevents                    == NULL) errCnt++;
     if(CO_HBcons_monitoredNodes         == NULL) errCnt++;
-  #if CO_NO_SDO_CLIENT == 1
-    if(CO->SDOclient                    == NULL) errCnt++;
+  #if CO_NO_EM_CONS > 0
+    if(CO->EMcons                       == NULL) errCnt++;
+    if(CO_EMcons_nodes                  == NULL) errCnt++;
+  #endif
+    if(CO->DCF                          == NULL) errCnt++;
+  #if CO_NO_SDO_CLIENT > 0
+    for(i=0; i<CO_NO_SDO_CLIENT; i++){
+        if(CO->SDOclient[i]             == NULL) errCnt++;
+    }
+    if(CO->SDOclientEngine              == NULL) errCnt++;
+    if(CO_SDOclientEngine_active        == NULL) errCnt++;
   #endif
 
     if(errCnt != 0) return CO_ERROR_OUT_OF_MEMORY;
@@ -433,6 +549,45 @@ int16_t CO_init(){
 
     if(err){CO_delete(); return err;}
 
+    CO_SYNCnew = 0;
+
+    err = CO_SYNC_initJitter(
+            CO->SYNC,
+            CO->SDO,
+            OD_SYNCJitter,
+            ODL_SYNCJitter_arrayLength,
+            0x2108);
+
+    if(err){CO_delete(); return err;}
+
+
+#if CO_NO_TIME > 0
+    err = CO_TIME_init(
+            CO->TIME,
+            CO->EM,
+            CO->SDO,
+           &CO->NMT->operatingState,
+            OD_COB_ID_TIME,
+            1000,
+            CO->CANmodule[0],
+            CO_RXCAN_TIME,
+            CO->CANmodule[0],
+            CO_TXCAN_TIME);
+
+    if(err){CO_delete(); return err;}
+
+  #if CO_TIME_FOLLOW_UP == 1
+    err = CO_TIME_initFollowUp(
+            CO->TIME,
+            CO_TIME_FOLLOW_UP_COB_ID,
+            CO->CANmodule[0],
+            CO_RXCAN_TIME_FU,
+            CO_TXCAN_TIME_FU);
+
+    if(err){CO_delete(); return err;}
+  #endif
+#endif
+
 
     for(i=0; i<CO_NO_RPDO; i++){
         CO_CANmodule_t *CANdevRx = CO->CANmodule[0];
@@ -451,7 +606,7 @@ int16_t CO_init(){
                 CO->SDO,
                &CO->NMT->operatingState,
                 nodeId,
-                ((i<4) ? (CO_CAN_ID_RPDO0+i*0x100) : 0),
+                CO_PDO_defaultCOB_ID(i, 0, nodeId),
                 0,
                 (CO_RPDOCommPar_t*) &OD_RPDOCommunicationParameter[i],
                 (CO_RPDOMapPar_t*) &OD_RPDOMappingParameter[i],
@@ -461,6 +616,17 @@ int16_t CO_init(){
                 CANdevRxIdx);
 
         if(err){CO_delete(); return err;}
+
+#ifdef ODL_RPDOStatistics_arrayLength
+        err = CO_RPDO_initStatistics(
+                CO->RPDO[i],
+                CO->SDO,
+                OD_RPDOStatistics[i],
+                ODL_RPDOStatistics_arrayLength,
+                0x2118+i);
+
+        if(err){CO_delete(); return err;}
+#endif
     }
 
 
@@ -471,7 +637,7 @@ int16_t CO_init(){
                 CO->SDO,
                &CO->NMT->operatingState,
                 nodeId,
-                ((i<4) ? (CO_CAN_ID_TPDO0+i*0x100) : 0),
+                CO_PDO_defaultCOB_ID(i, 1, nodeId),
                 0,
                 (CO_TPDOCommPar_t*) &OD_TPDOCommunicationParameter[i],
                 (CO_TPDOMapPar_t*) &OD_TPDOMappingParameter[i],
@@ -481,8 +647,70 @@ int16_t CO_init(){
                 CO_TXCAN_TPDO+i);
 
         if(err){CO_delete(); return err;}
+
+#if CO_TPDO_HIGH_RES == 1
+        err = CO_TPDO_initHighRes(
+                CO->TPDO[i],
+               &OD_TPDOEventTimeUs[i]);
+
+        if(err){CO_delete(); return err;}
+#endif
+
+#if CO_TPDO_PHASE_SPREAD == 1
+        /* spread TPDOs evenly over the event timer period, shift by node-ID across nodes */
+        CO->TPDO[i]->eventPhase = (uint16_t)(((uint32_t)i * 128 + nodeId) * 0x10000L / (CO_NO_TPDO * 128));
+#endif
+
+        err = CO_TPDO_initSYNCoffset(
+                CO->TPDO[i],
+                CO->SDO,
+                CO->SYNC,
+               &OD_TPDOSYNCOffset[i],
+                0x2114);
+
+        if(err){CO_delete(); return err;}
+
+        err = CO_TPDO_initGroup(
+                CO->TPDO[i],
+               &OD_TPDOGroup[i]);
+
+        if(err){CO_delete(); return err;}
+
+#if CO_NO_TPDO_RTR > 0
+        if(i < CO_NO_TPDO_RTR){
+            err = CO_TPDO_initRTR(
+                    CO->TPDO[i],
+                    CO->CANmodule[0],
+                    CO_RXCAN_TPDO_RTR+i);
+
+            if(err){CO_delete(); return err;}
+        }
+#endif
+
+#ifdef ODL_TPDOSYNCLatency_arrayLength
+        err = CO_TPDO_initLatency(
+                CO->TPDO[i],
+                CO->SDO,
+                CO->SYNC,
+                OD_TPDOSYNCLatency[i],
+                ODL_TPDOSYNCLatency_arrayLength,
+                0x2110+i);
+
+        if(err){CO_delete(); return err;}
+#endif
     }
 
+    err = CO_TPDOmonitor_init(
+            CO->TPDOmon,
+            CO->EM,
+            CO->TPDO,
+            CO_NO_TPDO,
+            nodeId,
+            CO->CANmodule[0],
+            CO_RXCAN_TPDO_MON);
+
+    if(err){CO_delete(); return err;}
+
 
     err = CO_HBconsumer_init(
             CO->HBcons,
@@ -496,16 +724,52 @@ int16_t CO_init(){
 
     if(err){CO_delete(); return err;}
 
+    CO_NMTevents_init(CO->NMTevents);
+    CO_NMT_initEvents(CO->NMT, CO->NMTevents);
+    CO_HBconsumer_initEvents(CO->HBcons, CO->NMTevents);
 
-#if CO_NO_SDO_CLIENT == 1
-    err = CO_SDOclient_init(
-            CO->SDOclient,
+
+#if CO_NO_EM_CONS > 0
+    err = CO_EMcons_init(
+            CO->EMcons,
             CO->SDO,
-            (CO_SDOclientPar_t*) &OD_SDOClientParameter[0],
-            CO->CANmodule[0],
-            CO_RXCAN_SDO_CLI,
+           &CO->NMT->operatingState,
+           &OD_emergencyConsumer[0],
+            CO_EMcons_nodes,
+            ODL_emergencyConsumer_arrayLength,
             CO->CANmodule[0],
-            CO_TXCAN_SDO_CLI);
+            CO_RXCAN_EM_CONS);
+
+    if(err){CO_delete(); return err;}
+#endif
+
+
+    err = CO_DCF_init(
+            CO->DCF,
+            CO->SDO);
+
+    if(err){CO_delete(); return err;}
+
+
+#if CO_NO_SDO_CLIENT > 0
+    for(i=0; i<CO_NO_SDO_CLIENT; i++){
+        err = CO_SDOclient_init(
+                CO->SDOclient[i],
+                CO->SDO,
+                (CO_SDOclientPar_t*) &OD_SDOClientParameter[i],
+                CO->CANmodule[0],
+                CO_RXCAN_SDO_CLI+i,
+                CO->CANmodule[0],
+                CO_TXCAN_SDO_CLI+i);
+
+        if(err){CO_delete(); return err;}
+    }
+
+    err = CO_SDOclientEngine_init(
+            CO->SDOclientEngine,
+            CO->SDOclient,
+            CO_SDOclientEngine_active,
+            CO_NO_SDO_CLIENT);
 
     if(err){CO_delete(); return err;}
 #endif
@@ -531,17 +795,31 @@ void CO_delete(){
 #endif
 
 #ifndef CO_USE_GLOBALS
-  #if CO_NO_SDO_CLIENT == 1
-    free(CO->SDOclient);
+  #if CO_NO_SDO_CLIENT > 0
+    free(CO_SDOclientEngine_active);
+    free(CO->SDOclientEngine);
+    for(i=0; i<CO_NO_SDO_CLIENT; i++){
+        free(CO->SDOclient[i]);
+    }
+  #endif
+    free(CO->DCF);
+  #if CO_NO_EM_CONS > 0
+    free(CO_EMcons_nodes);
+    free(CO->EMcons);
   #endif
     free(CO_HBcons_monitoredNodes);
+    free(CO->NMTevents);
     free(CO->HBcons);
     for(i=0; i<CO_NO_RPDO; i++){
         free(CO->RPDO[i]);
     }
+    free(CO->TPDOmon);
     for(i=0; i<CO_NO_TPDO; i++){
         free(CO->TPDO[i]);
     }
+  #if CO_NO_TIME > 0
+    free(CO->TIME);
+  #endif
     free(CO->SYNC);
     free(CO->NMT);
     free(CO->EMpr);
@@ -601,12 +879,26 @@ uint8_t CO_process(
             OD_errorRegister,
             OD_errorBehavior);
             
+#if CO_NO_TIME > 0
+    CO_TIME_process(
+            CO->TIME,
+            timeDifference_ms);
+#endif
     
     
     CO_HBconsumer_process(
             CO->HBcons,
             NMTisPreOrOperational,
             timeDifference_ms);
+
+    CO_NMTevents_process(CO->NMTevents);
+
+#if CO_NO_SDO_CLIENT > 0
+    CO_SDOclientEngine_process(
+            CO->SDOclientEngine,
+            timeDifference_ms,
+            CO_SDO_CLIENT_TIMEOUT);
+#endif
     
 
     return reset;
@@ -619,9 +911,12 @@ void CO_process_RPDO(CO_t *CO){
     int16_t i;
 
     SYNCret = CO_SYNC_process(CO->SYNC, 200L, OD_synchronousWindowLength);
+    if(SYNCret == 1) CO_SYNCnew = 1;
     if(SYNCret == 2) CO_CANclearPendingSyncPDOs(CO->CANmodule[0]);
 
     for(i=0; i<CO_NO_RPDO; i++){
+        /* shadow mapping changes at SYNC boundary or at once without SYNC */
+        if(SYNCret == 1 || !CO->SYNC->running) CO_RPDO_swapMap(CO->RPDO[i]);
         CO_RPDO_process(CO->RPDO[i]);
     }
 }
@@ -630,16 +925,34 @@ void CO_process_RPDO(CO_t *CO){
 /******************************************************************************/
 void CO_process_TPDO(CO_t *CO){
     int16_t i;
-      
-    CO_SYNC_t sync;
-    sync = *(CO->SYNC);
-    
-    /* Verify PDO Change Of State and process PDOs */
+
+    /* Verify PDO Change Of State */
     for(i=0; i<CO_NO_TPDO; i++){
         if(!CO->TPDO[i]->sendRequest){
           CO->TPDO[i]->sendRequest = CO_TPDOisCOS(CO->TPDO[i]);
         }
-        //CO_TPDO_process(CO->TPDO[i], CO->SYNC, 10, 1);
-        CO_TPDO_process(CO->TPDO[i], &sync, 2, 1);
+    }
+
+    /* Synchronous PDOs: determine all PDOs due at the new SYNC first, then
+     * send them one after another in their time slots. PDOs without transmit
+     * offset are queued together. */
+    if(CO_SYNCnew){
+        CO_SYNCnew = 0;
+        for(i=0; i<CO_NO_TPDO; i++){
+            CO_TPDO_swapMap(CO->TPDO[i]);
+            CO->TPDO[i]->SYNCpending = CO_TPDOisSYNC(CO->TPDO[i], CO->SYNC);
+        }
+        CO_TPDO_latchSYNC(CO->TPDO, CO_NO_TPDO);
+    }
+    else if(!CO->SYNC->running){
+        for(i=0; i<CO_NO_TPDO; i++) CO_TPDO_swapMap(CO->TPDO[i]);
+    }
+    for(i=0; i<CO_NO_TPDO; i++){
+        if(CO_TPDOisSYNCslot(CO->TPDO[i])) CO_TPDOsend(CO->TPDO[i]);
+    }
+
+    /* Process other PDOs */
+    for(i=0; i<CO_NO_TPDO; i++){
+        CO_TPDO_process(CO->TPDO[i], 2, 1);
     }
 }
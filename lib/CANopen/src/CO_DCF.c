@@ -0,0 +1,223 @@
+/*
+ * CANopen Concise DCF (Device Configuration File) object.
+ *
+ * @file        CO_DCF.c
+ * @ingroup     CO_DCF
+ * @version     SVN: \$Id: CO_DCF.c 32 2013-03-11 08:24:27Z jani22 $
+ * @author      Janez Paternoster
+ * @copyright   2013 Janez Paternoster
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "CO_driver.h"
+#include "CO_SDO.h"
+#include "CO_DCF.h"
+
+
+/* States of the Concise DCF parser */
+#define CO_DCF_STATE_COUNT      0   /* receiving number of entries */
+#define CO_DCF_STATE_HEADER     1   /* receiving index, subIndex and size */
+#define CO_DCF_STATE_DATA       2   /* receiving data of the entry */
+#define CO_DCF_STATE_END        3   /* all entries received */
+
+
+/*
+ * Write one received entry into Object dictionary.
+ *
+ * SDO->ODF_arg and SDO->entryNo belong to the ongoing 0x1F22 transfer, so
+ * they are saved before and restored after the write.
+ */
+static uint32_t CO_DCF_writeEntry(CO_DCF_t *DCF){
+    CO_SDO_t *SDO = DCF->SDO;
+    CO_ODF_arg_t ODF_argSaved = SDO->ODF_arg;
+    uint16_t entryNoSaved = SDO->entryNo;
+    uint32_t abortCode;
+
+    if(DCF->index == CO_DCF_INDEX)
+        abortCode = 0x08000020L;    /* Concise DCF can not contain itself */
+    else
+        abortCode = CO_SDO_initTransfer(SDO, DCF->index, DCF->subIndex);
+
+    if(abortCode == 0){
+        SDO->ODF_arg.data = DCF->valueBuffer;
+        SDO->ODF_arg.dataLengthTotal = DCF->dataSize;
+        abortCode = CO_SDO_writeOD(SDO, (uint16_t)DCF->dataSize);
+    }
+
+    SDO->ODF_arg = ODF_argSaved;
+    SDO->entryNo = entryNoSaved;
+
+    if(abortCode == 0)
+        DCF->entriesWritten++;
+
+    return abortCode;
+}
+
+
+/*
+ * Function for accessing _Concise DCF_ (index 0x1F22) from SDO server.
+ *
+ * Data are received in segments, so the function parses them as a stream.
+ * For more information see file CO_SDO.h.
+ */
+static uint32_t CO_ODF_1F22(CO_ODF_arg_t *ODF_arg){
+    CO_DCF_t *DCF;
+    uint8_t *data;
+    uint16_t length;
+    uint8_t lastSegment;
+
+    DCF = (CO_DCF_t*) ODF_arg->object;
+
+    /* number of entries (subIndex 0) is readable, Concise DCF is write only */
+    if(ODF_arg->reading)
+        return (ODF_arg->subIndex == 0) ? 0 : 0x06010001L;
+
+    /* Concise DCF is accepted only for own node-ID */
+    if(ODF_arg->subIndex != DCF->SDO->nodeId)
+        return 0x08000020L;     /* Data cannot be transferred or stored to the application */
+
+    /* ODF_arg will be changed by writing the entries, so copy the values first */
+    data = ODF_arg->data;
+    length = ODF_arg->dataLength;
+    lastSegment = ODF_arg->lastSegment;
+
+    if(ODF_arg->firstSegment){
+        DCF->state = CO_DCF_STATE_COUNT;
+        DCF->bufferOffset = 0;
+        DCF->entriesLeft = 0;
+        DCF->entriesWritten = 0;
+    }
+
+    while(length--){
+        uint8_t b = *(data++);
+
+        switch(DCF->state){
+            case CO_DCF_STATE_COUNT:
+                DCF->headerBuffer[DCF->bufferOffset++] = b;
+                if(DCF->bufferOffset == 4){
+                    memcpySwap4((uint8_t*)&DCF->entriesLeft, &DCF->headerBuffer[0]);
+                    DCF->bufferOffset = 0;
+                    DCF->state = (DCF->entriesLeft > 0) ? CO_DCF_STATE_HEADER : CO_DCF_STATE_END;
+                }
+                break;
+
+            case CO_DCF_STATE_HEADER:
+                DCF->headerBuffer[DCF->bufferOffset++] = b;
+                if(DCF->bufferOffset == 7){
+                    memcpySwap2((uint8_t*)&DCF->index, &DCF->headerBuffer[0]);
+                    DCF->subIndex = DCF->headerBuffer[2];
+                    memcpySwap4((uint8_t*)&DCF->dataSize, &DCF->headerBuffer[3]);
+                    DCF->bufferOffset = 0;
+                    if(DCF->dataSize > CO_SDO_BUFFER_SIZE)
+                        return 0x06070012L;     /* Length of service parameter too high */
+                    if(DCF->dataSize == 0)
+                        return 0x06070013L;     /* Length of service parameter too low */
+                    DCF->state = CO_DCF_STATE_DATA;
+                }
+                break;
+
+            case CO_DCF_STATE_DATA:
+                DCF->valueBuffer[DCF->bufferOffset++] = b;
+                if(DCF->bufferOffset == DCF->dataSize){
+                    uint32_t abortCode = CO_DCF_writeEntry(DCF);
+                    if(abortCode) return abortCode;
+                    DCF->bufferOffset = 0;
+                    DCF->state = (--DCF->entriesLeft > 0) ? CO_DCF_STATE_HEADER : CO_DCF_STATE_END;
+                }
+                break;
+
+            default:
+                return 0x06070012L;     /* Length of service parameter too high */
+        }
+    }
+
+    /* verify, if all entries were received */
+    if(lastSegment && DCF->state != CO_DCF_STATE_END)
+        return 0x06070013L;     /* Length of service parameter too low */
+
+    return 0;
+}
+
+
+/******************************************************************************/
+int16_t CO_DCF_init(
+        CO_DCF_t               *DCF,
+        CO_SDO_t               *SDO)
+{
+    /* Configure object variables */
+    DCF->SDO = SDO;
+    DCF->state = CO_DCF_STATE_END;
+    DCF->bufferOffset = 0;
+    DCF->entriesLeft = 0;
+    DCF->entriesWritten = 0;
+
+    /* Configure Object dictionary entry at index 0x1F22 */
+    CO_OD_configure(SDO, CO_DCF_INDEX, CO_ODF_1F22, (void*)DCF, 0, 0);
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+int8_t CO_DCF_addEntry(
+        uint8_t                *dcf,
+        uint32_t                dcfSize,
+        uint32_t               *pDcfLength,
+        uint16_t                index,
+        uint8_t                 subIndex,
+        const uint8_t          *data,
+        uint32_t                dataSize)
+{
+    uint32_t numberOfEntries = 0;
+    uint32_t len;
+    uint8_t *p;
+
+    /* verify arguments */
+    if(dcf == 0 || pDcfLength == 0 || data == 0 || dataSize == 0 || dcfSize < 4)
+        return -2;
+
+    /* new Concise DCF starts with number of entries */
+    len = *pDcfLength;
+    if(len < 4){
+        len = 4;
+    }
+    else{
+        memcpySwap4((uint8_t*)&numberOfEntries, dcf);
+    }
+
+    if((dcfSize - len) < (7 + dataSize))
+        return -2;
+
+    /* add entry */
+    p = &dcf[len];
+    memcpySwap2(p, (uint8_t*)&index);
+    p[2] = subIndex;
+    memcpySwap4(&p[3], (uint8_t*)&dataSize);
+    p += 7;
+    len += 7 + dataSize;
+    while(dataSize--) *(p++) = *(data++);
+
+    /* update number of entries */
+    numberOfEntries++;
+    memcpySwap4(dcf, (uint8_t*)&numberOfEntries);
+    *pDcfLength = len;
+
+    return 0;
+}
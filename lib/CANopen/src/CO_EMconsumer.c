@@ -0,0 +1,258 @@
+/*
+ * CANopen Emergency consumer object.
+ *
+ * @file        CO_EMconsumer.c
+ * @ingroup     CO_EMconsumer
+ * @version     SVN: \$Id: CO_EMconsumer.c 32 2013-03-11 08:24:27Z jani22 $
+ * @author      Janez Paternoster
+ * @copyright   2013 Janez Paternoster
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "CO_driver.h"
+#include "CO_timer.h"
+#include "CO_SDO.h"
+#include "CO_Emergency.h"
+#include "CO_NMT_Heartbeat.h"
+#include "CO_EMconsumer.h"
+
+
+/*
+ * Read received message from CAN module.
+ *
+ * Function will be called (by CAN receive interrupt) every time, when CAN
+ * message with correct identifier will be received. For more information and
+ * description of parameters see file CO_driver.h.
+ */
+static int16_t CO_EMcons_receive(void *object, CO_CANrxMsg_t *msg){
+    CO_EMcons_t *EMcons;
+    CO_EMconsNode_t *node;
+    CO_EMconsMsg_t *entry;
+    uint16_t ident;
+    uint8_t idx, i;
+
+    EMcons = (CO_EMcons_t*)object;   /* this is the correct pointer type of the first argument */
+
+    if(*EMcons->operatingState != CO_NMT_OPERATIONAL && *EMcons->operatingState != CO_NMT_PRE_OPERATIONAL)
+        return CO_ERROR_NO;
+
+    /* identifier 0x080 is SYNC */
+    ident = CO_CANrxMsg_readIdent(msg);
+    if(ident <= 0x080 || ident > 0x0FF) return CO_ERROR_NO;
+
+    idx = EMcons->nodeIndex[ident - 0x081];
+    if(idx >= EMcons->numberOfNodes) return CO_ERROR_NO;
+
+    /* verify message length */
+    if(msg->DLC != 8) return CO_ERROR_RX_MSG_LENGTH;
+
+    /* write into history, the oldest message is overwritten */
+    node = &EMcons->nodes[idx];
+    entry = &node->history[node->rxCount & (CO_EM_CONS_HISTORY-1)];
+    entry->timestamp = getTimeNow_us();
+    for(i=0; i<8; i++) entry->data[i] = msg->data[i];
+    node->rxCount++;
+    if(node->noOfMsgs < CO_EM_CONS_HISTORY) node->noOfMsgs++;
+
+    if(EMcons->pFunctSignal)
+        EMcons->pFunctSignal(EMcons->functSignalObject, (uint8_t)(ident - 0x080), entry);
+
+    return CO_ERROR_NO;
+}
+
+
+/*
+ * Configure one entry from _Emergency consumer object_.
+ */
+static void CO_EMcons_nodeConfig(
+        CO_EMcons_t            *EMcons,
+        uint8_t                 idx,
+        uint32_t                COB_IDvalue)
+{
+    CO_EMconsNode_t *node = &EMcons->nodes[idx];
+    uint16_t COB_ID = (uint16_t)(COB_IDvalue & 0x7FF);
+
+    /* remove old identifier, receive interrupt then ignores the node */
+    if(node->COB_ID) EMcons->nodeIndex[node->COB_ID - 0x081] = 0xFF;
+
+    DISABLE_INTERRUPTS();
+    node->COB_ID = 0;
+    node->rxCount = 0;
+    node->noOfMsgs = 0;
+    ENABLE_INTERRUPTS();
+
+    /* is entry valid */
+    if((COB_IDvalue & 0x80000000L) == 0 && COB_ID > 0x080 && COB_ID <= 0x0FF){
+        node->COB_ID = COB_ID;
+        EMcons->nodeIndex[COB_ID - 0x081] = idx;
+    }
+}
+
+
+/*
+ * Function for accessing _Emergency consumer object_ (index 0x1028) from SDO
+ * server.
+ *
+ * For more information see file CO_SDO.h.
+ */
+static uint32_t CO_ODF_1028(CO_ODF_arg_t *ODF_arg){
+    CO_EMcons_t *EMcons;
+    uint32_t *value;
+
+    EMcons = (CO_EMcons_t*) ODF_arg->object;
+    value = (uint32_t*) ODF_arg->data;
+
+    if(!ODF_arg->reading && ODF_arg->subIndex > 0){
+        uint16_t COB_ID = *value & 0x7FF;
+        uint8_t idx = ODF_arg->subIndex - 1;
+
+        /* only 11-bit CAN identifier is supported */
+        if(*value & 0x7FFFF800L) return 0x06090030L; /* Invalid value for parameter (download only). */
+
+        if((*value & 0x80000000L) == 0){
+            uint8_t other;
+
+            /* only default range of Emergency identifiers is supported */
+            if(COB_ID <= 0x080 || COB_ID > 0x0FF)
+                return 0x06090030L;  /* Invalid value for parameter (download only). */
+
+            /* identifier must not be used by other entry */
+            other = EMcons->nodeIndex[COB_ID - 0x081];
+            if(other != 0xFF && other != idx)
+                return 0x06040043L;  /* General parameter incompatibility reason. */
+        }
+
+        CO_EMcons_nodeConfig(EMcons, idx, *value);
+    }
+
+    return 0;
+}
+
+
+/******************************************************************************/
+int16_t CO_EMcons_init(
+        CO_EMcons_t            *EMcons,
+        CO_SDO_t               *SDO,
+        uint8_t                *operatingState,
+        const uint32_t         *EMconsCOB_ID,
+        CO_EMconsNode_t        *nodes,
+        uint8_t                 numberOfNodes,
+        CO_CANmodule_t         *CANdevRx,
+        uint16_t                CANdevRxIdx)
+{
+    uint8_t i;
+
+    /* verify arguments */
+    if(numberOfNodes == 0 || numberOfNodes > 127) return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    /* Configure object variables */
+    EMcons->operatingState = operatingState;
+    EMcons->nodes = nodes;
+    EMcons->numberOfNodes = numberOfNodes;
+    EMcons->pFunctSignal = 0;
+    EMcons->functSignalObject = 0;
+    EMcons->CANdevRx = CANdevRx;
+    EMcons->CANdevRxIdx = CANdevRxIdx;
+
+    for(i=0; i<127; i++) EMcons->nodeIndex[i] = 0xFF;
+
+    /* duplicated identifiers from Object Dictionary are not consumed */
+    for(i=0; i<numberOfNodes; i++){
+        uint16_t COB_ID = EMconsCOB_ID[i] & 0x7FF;
+
+        nodes[i].COB_ID = 0;
+        if(COB_ID > 0x080 && COB_ID <= 0x0FF && EMcons->nodeIndex[COB_ID - 0x081] != 0xFF)
+            CO_EMcons_nodeConfig(EMcons, i, 0x80000000L);
+        else
+            CO_EMcons_nodeConfig(EMcons, i, EMconsCOB_ID[i]);
+    }
+
+    /* Configure Object dictionary entry at index 0x1028 */
+    CO_OD_configure(SDO, 0x1028, CO_ODF_1028, (void*)EMcons, 0, 0);
+
+    /* configure Emergency CAN reception for the whole identifier range */
+    CO_CANrxBufferInit(
+            CANdevRx,               /* CAN device */
+            CANdevRxIdx,            /* rx buffer index */
+            0x080,                  /* CAN identifier */
+            0x780,                  /* mask */
+            0,                      /* rtr */
+            (void*)EMcons,          /* object passed to receive function */
+            CO_EMcons_receive);     /* this function will process received message */
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+void CO_EMcons_initCallback(
+        CO_EMcons_t            *EMcons,
+        void                   *object,
+        void                  (*pFunctSignal)(void *object, uint8_t nodeId, const CO_EMconsMsg_t *msg))
+{
+    DISABLE_INTERRUPTS();
+    EMcons->functSignalObject = object;
+    EMcons->pFunctSignal = pFunctSignal;
+    ENABLE_INTERRUPTS();
+}
+
+
+/******************************************************************************/
+uint8_t CO_EMcons_getHistory(
+        CO_EMcons_t            *EMcons,
+        uint8_t                 nodeId,
+        uint8_t                 age,
+        CO_EMconsMsg_t         *msg)
+{
+    CO_EMconsNode_t *node;
+    uint8_t idx;
+    uint8_t ret = 0;
+
+    if(nodeId == 0 || nodeId > 127 || age >= CO_EM_CONS_HISTORY) return 0;
+
+    idx = EMcons->nodeIndex[nodeId - 1];
+    if(idx >= EMcons->numberOfNodes) return 0;
+    node = &EMcons->nodes[idx];
+
+    DISABLE_INTERRUPTS();
+    if(node->noOfMsgs > age){
+        *msg = node->history[(uint16_t)(node->rxCount - 1 - age) & (CO_EM_CONS_HISTORY-1)];
+        ret = 1;
+    }
+    ENABLE_INTERRUPTS();
+
+    return ret;
+}
+
+
+/******************************************************************************/
+uint16_t CO_EMcons_getCount(
+        CO_EMcons_t            *EMcons,
+        uint8_t                 nodeId)
+{
+    uint8_t idx;
+
+    if(nodeId == 0 || nodeId > 127) return 0;
+
+    idx = EMcons->nodeIndex[nodeId - 1];
+    if(idx >= EMcons->numberOfNodes) return 0;
+
+    return EMcons->nodes[idx].rxCount;
+}
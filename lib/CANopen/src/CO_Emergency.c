@@ -32,6 +32,10 @@
 
 #include <stdlib.h> /*  for malloc, free */
 
+/* errorBit part of ERROR_xxx macro, which expands to errorBit, errorCode */
+#define CO_EM_ERRORBIT(err)             CO_EM_ERRORBIT_(err)
+#define CO_EM_ERRORBIT_(bit, code)      (bit)
+
 
 /*
  * Function for accessing _Pre-Defined Error Field_ (index 0x1003) from SDO server.
@@ -53,6 +57,14 @@ static uint32_t CO_ODF_1003(CO_ODF_arg_t *ODF_arg){
             *value = noOfErrors;
         else if(ODF_arg->subIndex > noOfErrors)
             return 0x08000024L;  /* No data available. */
+        else{
+            /* preDefErr is a ring, subIndex 1 is the newest error */
+            uint8_t *src, j;
+            uint16_t i = EMpr->preDefErrNewest + EMpr->preDefErrSize - (ODF_arg->subIndex - 1);
+            if(i >= EMpr->preDefErrSize) i -= EMpr->preDefErrSize;
+            src = (uint8_t*) &EMpr->preDefErr[i];
+            for(j=0; j<4; j++) value[j] = src[j];
+        }
     }
     else{
         /* only '0' may be written to subIndex 0 */
@@ -90,6 +102,144 @@ static uint32_t CO_ODF_1014(CO_ODF_arg_t *ODF_arg){
 }
 
 
+/*
+ * Write emergency message into internal buffer.
+ *
+ * Multiple producers (mainline and interrupts of any priority) may call the
+ * function at the same time. Slot is reserved by compare-and-swap of the
+ * write counter and published by its sequence number, see CO_EMslot_t.
+ *
+ * @param EM Emergency object.
+ * @param msg 8 bytes of the emergency message.
+ *
+ * @return 1 on success, -2 if buffer is full.
+ */
+static int8_t CO_EM_bufPut(CO_EM_t *EM, const uint8_t *msg){
+    uint16_t pos = EM->bufWriteCnt;
+
+    for(;;){
+        CO_EMslot_t *slot = &EM->buf[pos & (CO_EM_INTERNAL_BUFFER_SIZE-1)];
+        int16_t diff = (int16_t)(slot->sequence - pos);
+
+        if(diff == 0){
+            /* slot is free, reserve it. On failure pos is updated. */
+            if(CO_ATOMIC_CAS(&EM->bufWriteCnt, &pos, (uint16_t)(pos+1))){
+                uint8_t i;
+
+                for(i=0; i<8; i++) slot->data[i] = msg[i];
+                CO_MEMORY_BARRIER();
+                slot->sequence = pos + 1;
+                return 1;
+            }
+        }
+        else if(diff < 0){
+            /* buffer is full, CO_EM_process() reports the loss. Its own
+            report of the loss is not counted. */
+            if(msg[3] != CO_EM_ERRORBIT(ERROR_EMERGENCY_BUFFER_FULL)){
+                CO_ATOMIC_FETCH_ADD(&EM->bufOverflow, 1);
+                CO_ATOMIC_FETCH_ADD(&EM->bufOverflowTotal, 1);
+            }
+            return -2;
+        }
+        else{
+            /* other producer took the slot */
+            pos = EM->bufWriteCnt;
+        }
+    }
+}
+
+
+/*
+ * Return true, if emergency buffer has at least one free slot.
+ */
+static uint8_t CO_EM_bufHasFree(CO_EM_t *EM){
+    uint16_t pos = EM->bufWriteCnt;
+
+    return (EM->buf[pos & (CO_EM_INTERNAL_BUFFER_SIZE-1)].sequence == pos) ? 1 : 0;
+}
+
+
+/*
+ * Send emergency message and write it to _Pre Defined Error Field_.
+ *
+ * CAN transmit buffer must be free.
+ *
+ * @param EMpr This object.
+ * @param msg 8 bytes of the emergency message, byte 2 is replaced by the
+ * error register.
+ */
+static void CO_EM_send(CO_EMpr_t *EMpr, const uint8_t *msg){
+    uint8_t* CANtxData = EMpr->CANtxBuff->data;
+    uint32_t preDEF;
+    uint8_t* ppreDEF = (uint8_t*) &preDEF;
+    uint8_t i;
+
+    /* copy data into CAN buffer and preDefinedErrorField buffer */
+    for(i=0; i<8; i++) CANtxData[i] = msg[i];
+    CANtxData[2] = *EMpr->errorRegister;
+    for(i=0; i<4; i++) ppreDEF[i] = CANtxData[i];
+
+    /* reset inhibit timer */
+    EMpr->inhibitEmTimer = 0;
+
+    /* write to 'pre-defined error field' (object dictionary, index 0x1003),
+     * the oldest entry is overwritten */
+    if(EMpr->preDefErr && EMpr->preDefErrSize){
+        if(++EMpr->preDefErrNewest >= EMpr->preDefErrSize)
+            EMpr->preDefErrNewest = 0;
+        EMpr->preDefErr[EMpr->preDefErrNewest] = preDEF;
+        if(EMpr->preDefErrNoOfErrors < EMpr->preDefErrSize)
+            EMpr->preDefErrNoOfErrors++;
+    }
+
+    CO_CANsend(EMpr->CANdev, EMpr->CANtxBuff);
+}
+
+
+#if CO_EM_STORM_WINDOW > 0
+/*
+ * Find storm suppression window, into which emergency for errorBit must be
+ * collapsed. Window is open or it has aggregated emergency waiting for
+ * transmission.
+ *
+ * @return Pointer to window or NULL, if emergency must be sent.
+ */
+static CO_EMstorm_t *CO_EM_stormFind(CO_EMpr_t *EMpr, uint8_t errorBit){
+    uint8_t i;
+
+    for(i=0; i<CO_EM_STORM_SLOTS; i++){
+        CO_EMstorm_t *st = &EMpr->storm[i];
+        if(st->errorBit == errorBit && (st->timer < CO_EM_STORM_WINDOW || st->count))
+            return st;
+    }
+    return 0;
+}
+
+
+/*
+ * Open storm suppression window for errorBit, after its emergency was sent.
+ * If all windows are in use, error condition is not tracked.
+ */
+static void CO_EM_stormOpen(CO_EMpr_t *EMpr, uint8_t errorBit){
+    CO_EMstorm_t *st = 0;
+    uint8_t i;
+
+    for(i=0; i<CO_EM_STORM_SLOTS; i++){
+        CO_EMstorm_t *s = &EMpr->storm[i];
+        if(s->timer >= CO_EM_STORM_WINDOW && s->count == 0){
+            st = s;
+            if(s->errorBit == errorBit) break;
+        }
+    }
+    if(st){
+        st->errorBit = errorBit;
+        st->timer = 0;
+        st->count = 0;
+    }
+}
+#endif
+
+
 /******************************************************************************/
 int16_t CO_EM_init(
         CO_EM_t                *EM,
@@ -109,19 +259,28 @@ int16_t CO_EM_init(
     /* Configure object variables */
     EM->errorStatusBits         = errorStatusBits;
     EM->errorStatusBitsSize     = errorStatusBitsSize; if(errorStatusBitsSize < 6) return CO_ERROR_ILLEGAL_ARGUMENT;
-    EM->bufEnd                  = EM->buf + CO_EM_INTERNAL_BUFFER_SIZE * 8;
-    EM->bufWritePtr             = EM->buf;
-    EM->bufReadPtr              = EM->buf;
-    EM->bufFull                 = 0;
+    EM->bufWriteCnt             = 0;
+    EM->bufReadCnt              = 0;
+    EM->bufOverflow             = 0;
+    EM->bufOverflowTotal        = 0;
     EM->wrongErrorReport        = 0;
-    EM->errorReportBusy         = 0;
-    EM->errorReportBusyError    = 0;
+    for(i=0; i<CO_EM_INTERNAL_BUFFER_SIZE; i++) EM->buf[i].sequence = i;
     EMpr->EM                    = EM;
     EMpr->errorRegister         = errorRegister;
     EMpr->preDefErr             = preDefErr;
     EMpr->preDefErrSize         = preDefErrSize;
     EMpr->preDefErrNoOfErrors   = 0;
+    EMpr->preDefErrNewest       = 0;
+    EMpr->commErrorCount        = 0;
     EMpr->inhibitEmTimer        = 0;
+#if CO_EM_STORM_WINDOW > 0
+    for(i=0; i<CO_EM_STORM_SLOTS; i++){
+        EMpr->storm[i].timer = CO_EM_STORM_WINDOW;
+        EMpr->storm[i].count = 0;
+        EMpr->storm[i].errorBit = 0;
+    }
+    EMpr->stormCollapsedCount   = 0;
+#endif
 
     /* clear error status bits */
     for(i=0; i<errorStatusBitsSize; i++) EM->errorStatusBits[i] = 0;
@@ -154,13 +313,27 @@ void CO_EM_process(
 {
 
     CO_EM_t *EM = EMpr->EM;
+    CO_EMslot_t *slot;
     uint8_t errorRegister;
+    uint8_t msg[8];
+    uint8_t i;
+#if CO_EM_STORM_WINDOW > 0
+    CO_EMstorm_t *st;
+#endif
 
     /* verify errors from driver and other */
     CO_CANverifyErrors(EMpr->CANdev);
-    if(EM->errorReportBusyError){
-        CO_errorReport(EM, ERROR_ERROR_REPORT_BUSY, EM->errorReportBusyError);
-        EM->errorReportBusyError = 0;
+    if(EM->bufOverflow && CO_EM_bufHasFree(EM)){
+        /* new losses after the last report: reset error, so it is reported again */
+        if(CO_isError(EM, ERROR_EMERGENCY_BUFFER_FULL)){
+            CO_errorReset(EM, ERROR_EMERGENCY_BUFFER_FULL, 0);
+        }
+        else{
+            uint16_t lost = EM->bufOverflow;
+            /* count only the number, which was really queued */
+            if(CO_errorReport(EM, ERROR_EMERGENCY_BUFFER_FULL, lost) == 1)
+                CO_ATOMIC_FETCH_ADD(&EM->bufOverflow, (uint16_t)(0 - lost));
+        }
     }
     if(EM->wrongErrorReport){
         CO_errorReport(EM, ERROR_WRONG_ERROR_REPORT, EM->wrongErrorReport);
@@ -176,7 +349,7 @@ void CO_EM_process(
         
     /* communication error (overrun, error state) */
     if(EM->errorStatusBits[2] || EM->errorStatusBits[3]){
-        printf("EM->errorStatusBits[2] || EM->errorStatusBits[3]\n\r");
+        EMpr->commErrorCount++;
         errorRegister |= 0x10;
     }
     *EMpr->errorRegister = (*EMpr->errorRegister & 0xEE) | errorRegister;
@@ -184,51 +357,66 @@ void CO_EM_process(
     /* inhibit time */
     if(EMpr->inhibitEmTimer < EMinhTime) EMpr->inhibitEmTimer += timeDifference_100us;
 
-    /* send Emergency message. */
-    if(     NMTisPreOrOperational &&
-            !EMpr->CANtxBuff->bufferFull &&
-            EMpr->inhibitEmTimer >= EMinhTime &&
-            (EM->bufReadPtr != EM->bufWritePtr || EM->bufFull))
-    {
-        /* copy data from emergency buffer into CAN buffer and preDefinedErrorField buffer */
-        uint8_t* EMdataPtr = EM->bufReadPtr;
-        uint8_t* CANtxData = EMpr->CANtxBuff->data;
-        uint32_t preDEF;
-        uint8_t* ppreDEF = (uint8_t*) &preDEF;
-        *(CANtxData++) = *EMdataPtr; *(ppreDEF++) = *(EMdataPtr++);
-        *(CANtxData++) = *EMdataPtr; *(ppreDEF++) = *(EMdataPtr++);
-        *(CANtxData++) = *EMpr->errorRegister; *(ppreDEF++) = *EMpr->errorRegister; EMdataPtr++;
-        *(CANtxData++) = *EMdataPtr; *(ppreDEF++) = *(EMdataPtr++);
-        *(CANtxData++) = *(EMdataPtr++);
-        *(CANtxData++) = *(EMdataPtr++);
-        *(CANtxData++) = *(EMdataPtr++);
-        *(CANtxData++) = *(EMdataPtr++);
-
-        /* Update read buffer pointer and reset inhibit timer */
-        if(EMdataPtr == EM->bufEnd) EM->bufReadPtr = EM->buf;
-        else                        EM->bufReadPtr = EMdataPtr;
-        EMpr->inhibitEmTimer = 0;
-
-        /* verify message buffer overflow, then clear full flag */
-        if(EM->bufFull == 2){
-            EM->bufFull = 0;
-            CO_errorReport(EM, ERROR_EMERGENCY_BUFFER_FULL, 0);
-        }
+    slot = &EM->buf[EM->bufReadCnt & (CO_EM_INTERNAL_BUFFER_SIZE-1)];
+
+#if CO_EM_STORM_WINDOW > 0
+    /* storm suppression windows */
+    for(i=0; i<CO_EM_STORM_SLOTS; i++){
+        st = &EMpr->storm[i];
+        if((uint16_t)(CO_EM_STORM_WINDOW - st->timer) > timeDifference_100us)
+            st->timer += timeDifference_100us;
         else
-            EM->bufFull = 0;
+            st->timer = CO_EM_STORM_WINDOW;
+    }
 
-        /* write to 'pre-defined error field' (object dictionary, index 0x1003) */
-        if(EMpr->preDefErr){
-            uint8_t i;
+    /* collapse published emergencies, which are inside the window of its error condition */
+    while(slot->sequence == (uint16_t)(EM->bufReadCnt + 1)){
+        st = CO_EM_stormFind(EMpr, slot->data[3]);
+        if(!st) break;
 
-            if(EMpr->preDefErrNoOfErrors < EMpr->preDefErrSize)
-                EMpr->preDefErrNoOfErrors++;
-            for(i=EMpr->preDefErrNoOfErrors-1; i>0; i--)
-                EMpr->preDefErr[i] = EMpr->preDefErr[i-1];
-            EMpr->preDefErr[0] = preDEF;
+        for(i=0; i<8; i++) st->data[i] = slot->data[i];
+        if(st->count < 0xFFFF) st->count++;
+        EMpr->stormCollapsedCount++;
+
+        CO_MEMORY_BARRIER();
+        slot->sequence = EM->bufReadCnt + CO_EM_INTERNAL_BUFFER_SIZE;
+        EM->bufReadCnt++;
+        slot = &EM->buf[EM->bufReadCnt & (CO_EM_INTERNAL_BUFFER_SIZE-1)];
+    }
+#endif
+
+    if(     !NMTisPreOrOperational ||
+            EMpr->CANtxBuff->bufferFull ||
+            EMpr->inhibitEmTimer < EMinhTime)
+        return;
+
+#if CO_EM_STORM_WINDOW > 0
+    /* send aggregated emergency from expired window and open a new one */
+    for(i=0; i<CO_EM_STORM_SLOTS; i++){
+        st = &EMpr->storm[i];
+        if(st->timer >= CO_EM_STORM_WINDOW && st->count){
+            memcpySwap2(&st->data[6], (uint8_t*)&st->count);
+            st->timer = 0;
+            st->count = 0;
+            CO_EM_send(EMpr, st->data);
+            return;
         }
+    }
+#endif
+
+    /* send Emergency message, if the next slot is published */
+    if(slot->sequence == (uint16_t)(EM->bufReadCnt + 1)){
+        for(i=0; i<8; i++) msg[i] = slot->data[i];
 
-        CO_CANsend(EMpr->CANdev, EMpr->CANtxBuff);
+        /* release the slot for producers */
+        CO_MEMORY_BARRIER();
+        slot->sequence = EM->bufReadCnt + CO_EM_INTERNAL_BUFFER_SIZE;
+        EM->bufReadCnt++;
+
+#if CO_EM_STORM_WINDOW > 0
+        CO_EM_stormOpen(EMpr, msg[3]);
+#endif
+        CO_EM_send(EMpr, msg);
     }
 
     return;
@@ -240,7 +428,7 @@ int8_t CO_errorReport(CO_EM_t *EM, uint8_t errorBit, uint16_t errorCode, uint32_
     uint8_t index = errorBit >> 3;
     uint8_t bitmask = 1 << (errorBit & 0x7);
     uint8_t *errorStatusBits = &EM->errorStatusBits[index];
-    uint8_t *bufWritePtrCopy;
+    uint8_t msg[8];
 
     /* if error was allready reported, return */
     if((*errorStatusBits & bitmask) != 0) return 0;
@@ -253,42 +441,18 @@ int8_t CO_errorReport(CO_EM_t *EM, uint8_t errorBit, uint16_t errorCode, uint32_
         return -1;
     }
 
-    /* set error bit */
-    if(errorBit) *errorStatusBits |= bitmask; /* any error except NO_ERROR */
-
-    /* set busy flag. If allready busy, prepare for emergency and return. */
-    DISABLE_INTERRUPTS();
-    if(EM->errorReportBusy++){
-        EM->errorReportBusy--;
-        ENABLE_INTERRUPTS();
-        EM->errorReportBusyError = errorBit;
-        return -3;
+    /* set error bit, only one of concurrent callers sees the change */
+    if(errorBit){ /* any error except NO_ERROR */
+        if(CO_ATOMIC_FETCH_OR(errorStatusBits, bitmask) & bitmask) return 0;
     }
-    ENABLE_INTERRUPTS();
 
-    /* verify buffer full */
-    if(EM->bufFull){
-        EM->bufFull = 2;
-        EM->errorReportBusy--;
-        return -2;
-    }
+    /* prepare data for emergency message */
+    memcpySwap2(&msg[0], (uint8_t*)&errorCode);
+    msg[2] = 0;   /* Error register - written later */
+    msg[3] = errorBit;
+    memcpySwap4(&msg[4], (uint8_t*)&infoCode);
 
-    /* copy data for emergency message */
-    bufWritePtrCopy = EM->bufWritePtr;
-    memcpySwap2(bufWritePtrCopy, (uint8_t*)&errorCode);
-    bufWritePtrCopy += 3;   /* third bit is Error register - written later */
-    *(bufWritePtrCopy++) = errorBit;
-    memcpySwap4(bufWritePtrCopy, (uint8_t*)&infoCode);
-    bufWritePtrCopy += 4;
-
-    /* Update write buffer pointer */
-    if(bufWritePtrCopy == EM->bufEnd) EM->bufWritePtr = EM->buf;
-    else                              EM->bufWritePtr = bufWritePtrCopy;
-
-    /* verify buffer full, clear busy flag and return */
-    if(EM->bufWritePtr == EM->bufReadPtr) EM->bufFull = 1;
-    EM->errorReportBusy--;
-    return 1;
+    return CO_EM_bufPut(EM, msg);
 }
 
 
@@ -297,7 +461,7 @@ int8_t CO_errorReset(CO_EM_t *EM, uint8_t errorBit, uint16_t errorCode, uint32_t
     uint8_t index = errorBit >> 3;
     uint8_t bitmask = 1 << (errorBit & 0x7);
     uint8_t *errorStatusBits = &EM->errorStatusBits[index];
-    uint8_t *bufWritePtrCopy;
+    uint8_t msg[8];
 
     /* if error is allready cleared, return */
     if((*errorStatusBits & bitmask) == 0) return 0;
@@ -310,42 +474,17 @@ int8_t CO_errorReset(CO_EM_t *EM, uint8_t errorBit, uint16_t errorCode, uint32_t
         return -1;
     }
 
-    /* set busy flag. If allready busy, return. */
-    DISABLE_INTERRUPTS();
-    if(EM->errorReportBusy++){
-        EM->errorReportBusy--;
-        ENABLE_INTERRUPTS();
-        return -3;
-    }
-    ENABLE_INTERRUPTS();
-
-    /* erase error bit */
-    *errorStatusBits &= ~bitmask;
+    /* erase error bit, only one of concurrent callers sees the change */
+    if((CO_ATOMIC_FETCH_AND(errorStatusBits, (uint8_t)~bitmask) & bitmask) == 0) return 0;
 
-    /* verify buffer full */
-    if(EM->bufFull){
-        EM->bufFull = 2;
-        EM->errorReportBusy--;
-        return -2;
-    }
+    /* prepare data for emergency message */
+    msg[0] = 0;
+    msg[1] = 0;
+    msg[2] = 0;
+    msg[3] = errorBit;
+    memcpySwap4(&msg[4], (uint8_t*)&infoCode);
 
-    /* copy data for emergency message */
-    bufWritePtrCopy = EM->bufWritePtr;
-    *(bufWritePtrCopy++) = 0;
-    *(bufWritePtrCopy++) = 0;
-    *(bufWritePtrCopy++) = 0;
-    *(bufWritePtrCopy++) = errorBit;
-    memcpySwap4(bufWritePtrCopy, (uint8_t*)&infoCode);
-    bufWritePtrCopy += 4;
-
-    /* Update write buffer pointer */
-    if(bufWritePtrCopy == EM->bufEnd) EM->bufWritePtr = EM->buf;
-    else                              EM->bufWritePtr = bufWritePtrCopy;
-
-    /* verify buffer full, clear busy flag and return */
-    if(EM->bufWritePtr == EM->bufReadPtr) EM->bufFull = 1;
-    EM->errorReportBusy--;
-    return 1;
+    return CO_EM_bufPut(EM, msg);
 }
 
 
@@ -27,6 +27,7 @@
 
 
 #include "CO_driver.h"
+#include "CO_timer.h"
 #include "CO_SDO.h"
 #include "CO_Emergency.h"
 #include "CO_NMT_Heartbeat.h"
@@ -42,57 +43,174 @@
  * description of parameters see file CO_driver.h.
  */
 static int16_t CO_HBcons_receive(void *object, CO_CANrxMsg_t *msg){
+    CO_HBconsumer_t *HBcons;
     CO_HBconsNode_t *HBconsNode;
+    uint16_t ident;
+    uint8_t idx, wr;
+
+    HBcons = (CO_HBconsumer_t*) object; /* this is the correct pointer type of the first argument */
+
+    ident = CO_CANrxMsg_readIdent(msg);
+    if(ident <= 0x700 || ident > 0x77F) return CO_ERROR_NO;
 
-    HBconsNode = (CO_HBconsNode_t*) object; /* this is the correct pointer type of the first argument */
+    idx = HBcons->nodeIndex[ident - 0x701];
+    if(idx >= HBcons->numberOfMonitoredNodes) return CO_ERROR_NO;
+    HBconsNode = &HBcons->monitoredNodes[idx];
 
     /* verify message length */
     if(msg->DLC != 1) return CO_ERROR_RX_MSG_LENGTH;
 
     /* verify message overflow (previous message was not processed yet) */
     if(HBconsNode->CANrxNew) return CO_ERROR_RX_OVERFLOW;
+    wr = HBcons->rxQueueWr;
+    if((uint8_t)(wr - HBcons->rxQueueRd) >= 128) return CO_ERROR_RX_OVERFLOW;
 
-    /* copy data and set 'new message' flag */
-    HBconsNode->NMTstate = msg->data[0];
+    /* copy data, set 'new message' flag and queue the node */
+    HBconsNode->rxNMTstate = msg->data[0];
+    HBconsNode->rxTimestamp = getTimeNow_us();
     HBconsNode->CANrxNew = 1;
+    HBcons->rxQueue[wr & 127] = idx;
+    HBcons->rxQueueWr = wr + 1;
 
     return CO_ERROR_NO;
 }
 
 
 /*
- * Configure one monitored node.
+ * Set NMT state of the monitored node and count operational nodes.
+ */
+static void CO_HBcons_setState(
+        CO_HBconsumer_t        *HBcons,
+        CO_HBconsNode_t        *monitoredNode,
+        uint8_t                 NMTstate)
+{
+    if(monitoredNode->NMTstate == CO_NMT_OPERATIONAL) HBcons->noOfOperational--;
+    monitoredNode->NMTstate = NMTstate;
+    if(monitoredNode->NMTstate == CO_NMT_OPERATIONAL) HBcons->noOfOperational++;
+}
+
+
+/*
+ * Put monitored node with index idx to position pos in the heap.
+ */
+static void CO_HBcons_heapSet(CO_HBconsumer_t *HBcons, uint8_t pos, uint8_t idx){
+    HBcons->heap[pos] = idx;
+    HBcons->monitoredNodes[idx].heapPos = pos;
+}
+
+
+/*
+ * Return true, if deadline of monitored node idxA is before deadline of idxB.
+ */
+static uint8_t CO_HBcons_before(CO_HBconsumer_t *HBcons, uint8_t idxA, uint8_t idxB){
+    return ((int32_t)(HBcons->monitoredNodes[idxA].deadline - HBcons->monitoredNodes[idxB].deadline) < 0) ? 1 : 0;
+}
+
+
+/*
+ * Move element at pos towards the top of the heap.
+ */
+static void CO_HBcons_heapUp(CO_HBconsumer_t *HBcons, uint8_t pos){
+    uint8_t idx = HBcons->heap[pos];
+
+    while(pos > 0){
+        uint8_t parent = (pos - 1) / 2;
+        if(!CO_HBcons_before(HBcons, idx, HBcons->heap[parent])) break;
+        CO_HBcons_heapSet(HBcons, pos, HBcons->heap[parent]);
+        pos = parent;
+    }
+    CO_HBcons_heapSet(HBcons, pos, idx);
+}
+
+
+/*
+ * Move element at pos towards the bottom of the heap.
+ */
+static void CO_HBcons_heapDown(CO_HBconsumer_t *HBcons, uint8_t pos){
+    uint8_t idx = HBcons->heap[pos];
+
+    for(;;){
+        uint16_t child = (uint16_t)pos * 2 + 1;
+        if(child >= HBcons->heapSize) break;
+        if(child + 1 < HBcons->heapSize && CO_HBcons_before(HBcons, HBcons->heap[child + 1], HBcons->heap[child]))
+            child++;
+        if(!CO_HBcons_before(HBcons, HBcons->heap[child], idx)) break;
+        CO_HBcons_heapSet(HBcons, pos, HBcons->heap[child]);
+        pos = (uint8_t)child;
+    }
+    CO_HBcons_heapSet(HBcons, pos, idx);
+}
+
+
+/*
+ * Remove monitored node from the heap, if it is there.
+ */
+static void CO_HBcons_heapRemove(CO_HBconsumer_t *HBcons, uint8_t idx){
+    uint8_t pos = HBcons->monitoredNodes[idx].heapPos;
+    uint8_t last;
+
+    if(pos == 0xFF) return;
+    HBcons->monitoredNodes[idx].heapPos = 0xFF;
+
+    last = HBcons->heap[--HBcons->heapSize];
+    if(last != idx){
+        CO_HBcons_heapSet(HBcons, pos, last);
+        CO_HBcons_heapUp(HBcons, pos);
+        CO_HBcons_heapDown(HBcons, HBcons->monitoredNodes[last].heapPos);
+    }
+}
+
+
+/*
+ * Insert monitored node into the heap or move it after its deadline changed.
+ */
+static void CO_HBcons_heapUpdate(CO_HBconsumer_t *HBcons, uint8_t idx){
+    uint8_t pos = HBcons->monitoredNodes[idx].heapPos;
+
+    if(pos == 0xFF){
+        pos = HBcons->heapSize++;
+        CO_HBcons_heapSet(HBcons, pos, idx);
+        CO_HBcons_heapUp(HBcons, pos);
+    }
+    else{
+        CO_HBcons_heapUp(HBcons, pos);
+        CO_HBcons_heapDown(HBcons, HBcons->monitoredNodes[idx].heapPos);
+    }
+}
+
+
+/*
+ * Configure one monitored node from its _Consumer Heartbeat Time_ entry.
  */
 static void CO_HBconsumer_monitoredNodeConfig(
         CO_HBconsumer_t        *HBcons,
-        uint8_t                 idx)
+        uint8_t                 idx,
+        uint32_t                HBconsTime)
 {
-    uint16_t COB_ID;
-    uint16_t NodeID = (uint16_t)((HBcons->HBconsTime[idx]>>16)&0xFF);
+    uint8_t NodeID = (uint8_t)((HBconsTime>>16)&0xFF);
+    uint16_t time = (uint16_t)HBconsTime;
     CO_HBconsNode_t *monitoredNode = &HBcons->monitoredNodes[idx];
 
-    monitoredNode->time = (uint16_t)HBcons->HBconsTime[idx];
-    monitoredNode->NMTstate = 0;
+    /* remove previous configuration. Message of the previous node, which may
+    still be in rxQueue, is invalidated by clearing CANrxNew. */
+    if(monitoredNode->nodeId) HBcons->nodeIndex[monitoredNode->nodeId - 1] = 0xFF;
+    DISABLE_INTERRUPTS();
+    monitoredNode->CANrxNew = 0;
+    ENABLE_INTERRUPTS();
+    if(monitoredNode->time) HBcons->noOfMonitored--;
+    CO_HBcons_heapRemove(HBcons, idx);
+    CO_HBcons_setState(HBcons, monitoredNode, 0);
+    monitoredNode->nodeId = 0;
+    monitoredNode->time = 0;
     monitoredNode->monStarted = 0;
 
     /* is channel used */
-    if(NodeID && monitoredNode->time){
-        COB_ID = NodeID + 0x700;
+    if(NodeID && NodeID <= 127 && time && HBcons->nodeIndex[NodeID - 1] == 0xFF){
+        monitoredNode->nodeId = NodeID;
+        monitoredNode->time = time;
+        HBcons->nodeIndex[NodeID - 1] = idx;
+        HBcons->noOfMonitored++;
     }
-    else{
-        COB_ID = 0;
-        monitoredNode->time = 0;
-    }
-
-    /* configure Heartbeat consumer CAN reception */
-    CO_CANrxBufferInit(
-            HBcons->CANdevRx,
-            HBcons->CANdevRxIdxStart + idx,
-            COB_ID,
-            0x7FF,
-            0,
-            (void*)&HBcons->monitoredNodes[idx],
-            CO_HBcons_receive);
 }
 
 
@@ -108,10 +226,9 @@ static uint32_t CO_ODF_1016(CO_ODF_arg_t *ODF_arg){
     HBcons = (CO_HBconsumer_t*) ODF_arg->object;
     value = (uint32_t*) ODF_arg->data;
 
-    if(!ODF_arg->reading){
+    if(!ODF_arg->reading && ODF_arg->subIndex > 0){
         uint8_t NodeID;
         uint16_t HBconsTime;
-        uint8_t i;
 
         NodeID = (*value >> 16) & 0xFF;
         HBconsTime = *value & 0xFFFF;
@@ -121,17 +238,13 @@ static uint32_t CO_ODF_1016(CO_ODF_arg_t *ODF_arg){
 
         if(HBconsTime && NodeID){
             /* there must not be more entries with same index and time different than zero */
-            for(i = 0; i<HBcons->numberOfMonitoredNodes; i++){
-                uint32_t objectCopy = HBcons->HBconsTime[i];
-                uint8_t NodeIDObj = (objectCopy >> 16) & 0xFF;
-                uint16_t HBconsTimeObj = objectCopy & 0xFFFF;
-                if((ODF_arg->subIndex-1)!=i && HBconsTimeObj && (NodeID == NodeIDObj))
-                    return 0x06040043L;  /* General parameter incompatibility reason. */
-            }
+            uint8_t other = HBcons->nodeIndex[NodeID - 1];
+            if(other != 0xFF && other != (ODF_arg->subIndex-1))
+                return 0x06040043L;  /* General parameter incompatibility reason. */
         }
 
         /* Configure */
-        CO_HBconsumer_monitoredNodeConfig(HBcons, ODF_arg->subIndex-1);
+        CO_HBconsumer_monitoredNodeConfig(HBcons, ODF_arg->subIndex-1, *value);
     }
 
     return 0;
@@ -147,82 +260,147 @@ int16_t CO_HBconsumer_init(
         CO_HBconsNode_t        *monitoredNodes,
         uint8_t                 numberOfMonitoredNodes,
         CO_CANmodule_t         *CANdevRx,
-        uint16_t                CANdevRxIdxStart)
+        uint16_t                CANdevRxIdx)
 {
     uint8_t i;
 
+    /* verify arguments */
+    if(numberOfMonitoredNodes == 0 || numberOfMonitoredNodes > 127) return CO_ERROR_ILLEGAL_ARGUMENT;
+
     /* Configure object variables */
     HBcons->EM = EM;
     HBcons->HBconsTime = HBconsTime;
     HBcons->monitoredNodes = monitoredNodes;
     HBcons->numberOfMonitoredNodes = numberOfMonitoredNodes;
     HBcons->allMonitoredOperational = 0;
+    HBcons->noOfMonitored = 0;
+    HBcons->noOfOperational = 0;
+    HBcons->wasPreOrOperational = 0;
+    HBcons->heapSize = 0;
+    HBcons->rxQueueWr = 0;
+    HBcons->rxQueueRd = 0;
+    HBcons->timeNow_ms = 0;
+    HBcons->events = 0;
     HBcons->CANdevRx = CANdevRx;
-    HBcons->CANdevRxIdxStart = CANdevRxIdxStart;
+    HBcons->CANdevRxIdx = CANdevRxIdx;
 
-    for(i=0; i<HBcons->numberOfMonitoredNodes; i++)
-        CO_HBconsumer_monitoredNodeConfig(HBcons, i);
+    for(i=0; i<127; i++) HBcons->nodeIndex[i] = 0xFF;
+
+    for(i=0; i<numberOfMonitoredNodes; i++){
+        CO_HBconsNode_t *monitoredNode = &monitoredNodes[i];
+        monitoredNode->NMTstate = 0;
+        monitoredNode->monStarted = 0;
+        monitoredNode->time = 0;
+        monitoredNode->nodeId = 0;
+        monitoredNode->heapPos = 0xFF;
+        monitoredNode->CANrxNew = 0;
+        CO_HBconsumer_monitoredNodeConfig(HBcons, i, HBconsTime[i]);
+    }
 
     /* Configure Object dictionary entry at index 0x1016 */
     CO_OD_configure(SDO, 0x1016, CO_ODF_1016, (void*)HBcons, 0, 0);
 
+    /* configure Heartbeat consumer CAN reception for all Node-IDs */
+    CO_CANrxBufferInit(
+            CANdevRx,
+            CANdevRxIdx,
+            0x700,
+            0x780,
+            0,
+            (void*)HBcons,
+            CO_HBcons_receive);
+
     return CO_ERROR_NO;
 }
 
 
+/******************************************************************************/
+void CO_HBconsumer_initEvents(
+        CO_HBconsumer_t        *HBcons,
+        CO_NMTevents_t         *events)
+{
+    HBcons->events = events;
+}
+
+
 /******************************************************************************/
 void CO_HBconsumer_process(
         CO_HBconsumer_t        *HBcons,
         uint8_t                 NMTisPreOrOperational,
         uint16_t                timeDifference_ms)
 {
-    uint8_t i;
-    uint8_t AllMonitoredOperationalCopy;
     CO_HBconsNode_t *monitoredNode;
+    uint8_t idx;
+
+    HBcons->timeNow_ms += timeDifference_ms;
 
-    AllMonitoredOperationalCopy = 5;
-    monitoredNode = &HBcons->monitoredNodes[0];
-
-    if(NMTisPreOrOperational){
-        for(i=0; i<HBcons->numberOfMonitoredNodes; i++){
-            if(monitoredNode->time){/* is node monitored */
-                /* Verify if new Consumer Heartbeat message received */
-                if(monitoredNode->CANrxNew){
-                    if(monitoredNode->NMTstate){
-                        /* not a bootup message */
-                        monitoredNode->monStarted = 1;
-                        monitoredNode->timeoutTimer = 0;  /* reset timer */
-                        timeDifference_ms = 0;
-                    }
-                    monitoredNode->CANrxNew = 0;
-                }
-                /* Verify timeout */
-                if(monitoredNode->timeoutTimer < monitoredNode->time) monitoredNode->timeoutTimer += timeDifference_ms;
-
-                if(monitoredNode->monStarted){
-                    if(monitoredNode->timeoutTimer >= monitoredNode->time){
-                        CO_errorReport(HBcons->EM, ERROR_HEARTBEAT_CONSUMER, i);
-                        monitoredNode->NMTstate = 0;
-                    }
-                    else if(monitoredNode->NMTstate == 0){
-                        /* there was a bootup message */
-                        CO_errorReport(HBcons->EM, ERROR_HEARTBEAT_CONSUMER_REMOTE_RESET, i);
-                    }
-                }
-                if(monitoredNode->NMTstate != CO_NMT_OPERATIONAL)
-                    AllMonitoredOperationalCopy = 0;
+    if(!NMTisPreOrOperational){ /* not in (pre)operational state */
+        if(HBcons->wasPreOrOperational){
+            for(idx=0; idx<HBcons->numberOfMonitoredNodes; idx++){
+                monitoredNode = &HBcons->monitoredNodes[idx];
+                monitoredNode->NMTstate = 0;
+                monitoredNode->monStarted = 0;
+                monitoredNode->heapPos = 0xFF;
             }
-            monitoredNode++;
+            HBcons->heapSize = 0;
+            HBcons->noOfOperational = 0;
+            HBcons->wasPreOrOperational = 0;
+        }
+        /* discard received messages */
+        while(HBcons->rxQueueRd != HBcons->rxQueueWr){
+            idx = HBcons->rxQueue[HBcons->rxQueueRd++ & 127];
+            HBcons->monitoredNodes[idx].CANrxNew = 0;
+        }
+        HBcons->allMonitoredOperational = 0;
+        return;
+    }
+    HBcons->wasPreOrOperational = 1;
+
+    /* received Heartbeat messages */
+    while(HBcons->rxQueueRd != HBcons->rxQueueWr){
+        uint8_t NMTstate;
+
+        idx = HBcons->rxQueue[HBcons->rxQueueRd++ & 127];
+        monitoredNode = &HBcons->monitoredNodes[idx];
+        if(!monitoredNode->CANrxNew) continue; /* invalidated by reconfiguration or already processed */
+        NMTstate = monitoredNode->rxNMTstate;
+        monitoredNode->CANrxNew = 0;
+
+        if(!monitoredNode->time) continue; /* node is not monitored any more */
+
+        if(NMTstate){
+            /* not a bootup message */
+            monitoredNode->monStarted = 1;
+            monitoredNode->deadline = HBcons->timeNow_ms + monitoredNode->time;
+            CO_HBcons_heapUpdate(HBcons, idx);
         }
+        else if(monitoredNode->monStarted && monitoredNode->heapPos != 0xFF){
+            /* there was a bootup message */
+            CO_errorReport(HBcons->EM, ERROR_HEARTBEAT_CONSUMER_REMOTE_RESET, idx);
+        }
+
+        if(HBcons->events && (NMTstate != monitoredNode->NMTstate || NMTstate == 0)){
+            CO_NMTevents_put(HBcons->events, monitoredNode->rxTimestamp,
+                    NMTstate ? CO_NMT_EVENT_STATE_CHANGE : CO_NMT_EVENT_BOOTUP,
+                    monitoredNode->nodeId, monitoredNode->NMTstate, NMTstate);
+        }
+        CO_HBcons_setState(HBcons, monitoredNode, NMTstate);
     }
-    else{ /* not in (pre)operational state */
-        for(i=0; i<HBcons->numberOfMonitoredNodes; i++){
-            monitoredNode->NMTstate = 0;
-            monitoredNode->CANrxNew = 0;
-            monitoredNode->monStarted = 0;
-            monitoredNode++;
+
+    /* expired deadlines */
+    while(HBcons->heapSize){
+        idx = HBcons->heap[0];
+        monitoredNode = &HBcons->monitoredNodes[idx];
+        if((int32_t)(HBcons->timeNow_ms - monitoredNode->deadline) < 0) break;
+
+        CO_HBcons_heapRemove(HBcons, idx);
+        CO_errorReport(HBcons->EM, ERROR_HEARTBEAT_CONSUMER, idx);
+        if(HBcons->events){
+            CO_NMTevents_put(HBcons->events, getTimeNow_us(), CO_NMT_EVENT_HB_TIMEOUT,
+                    monitoredNode->nodeId, monitoredNode->NMTstate, 0);
         }
-        AllMonitoredOperationalCopy = 0;
+        CO_HBcons_setState(HBcons, monitoredNode, 0);
     }
-    HBcons->allMonitoredOperational = AllMonitoredOperationalCopy;
+
+    HBcons->allMonitoredOperational = (HBcons->noOfOperational == HBcons->noOfMonitored) ? 1 : 0;
 }
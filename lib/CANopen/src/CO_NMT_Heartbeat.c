@@ -27,12 +27,32 @@
 
 
 #include "CO_driver.h"
+#include "CO_timer.h"
 #include "CO_SDO.h"
 #include "CO_Emergency.h"
 #include "CO_NMT_Heartbeat.h"
 
 #include <stdlib.h> /*  for malloc, free */
 
+/*
+ * Change NMT state of this node and put event into NMT event queue.
+ *
+ * Function is called from CAN receive interrupt and from mainline.
+ */
+static void CO_NMT_setState(CO_NMT_t *NMT, uint8_t state){
+    uint8_t oldState;
+
+    /* mainline call may be interrupted by CO_NMT_receive() */
+    DISABLE_INTERRUPTS();
+    oldState = NMT->operatingState;
+    NMT->operatingState = state;
+    ENABLE_INTERRUPTS();
+
+    if(NMT->events && state != oldState)
+        CO_NMTevents_put(NMT->events, getTimeNow_us(), CO_NMT_EVENT_STATE_CHANGE, NMT->nodeId, oldState, state);
+}
+
+
 /*
  * Read received message from CAN module.
  *
@@ -56,9 +76,9 @@ static int16_t CO_NMT_receive(void *object, CO_CANrxMsg_t *msg){
 
         switch(command){
             case CO_NMT_ENTER_OPERATIONAL:      if(!(*NMT->EMpr->errorRegister))
-                                                    NMT->operatingState = CO_NMT_OPERATIONAL;   break;
-            case CO_NMT_ENTER_STOPPED:          NMT->operatingState = CO_NMT_STOPPED;           break;
-            case CO_NMT_ENTER_PRE_OPERATIONAL:  NMT->operatingState = CO_NMT_PRE_OPERATIONAL;   break;
+                                                    CO_NMT_setState(NMT, CO_NMT_OPERATIONAL);   break;
+            case CO_NMT_ENTER_STOPPED:          CO_NMT_setState(NMT, CO_NMT_STOPPED);           break;
+            case CO_NMT_ENTER_PRE_OPERATIONAL:  CO_NMT_setState(NMT, CO_NMT_PRE_OPERATIONAL);   break;
             case CO_NMT_RESET_NODE:             NMT->resetCommand = 2;                          break;
             case CO_NMT_RESET_COMMUNICATION:    NMT->resetCommand = 1;                          break;
             default: CO_errorReport(NMT->EMpr->EM, ERROR_NMT_WRONG_COMMAND, command);
@@ -69,6 +89,81 @@ static int16_t CO_NMT_receive(void *object, CO_CANrxMsg_t *msg){
 }
 
 
+/******************************************************************************/
+void CO_NMTevents_init(CO_NMTevents_t *events){
+    events->writeCnt = 0;
+    events->readCnt = 0;
+    events->overflow = 0;
+    events->pFunctSignal = 0;
+    events->functSignalObject = 0;
+}
+
+
+/******************************************************************************/
+void CO_NMTevents_initCallback(
+        CO_NMTevents_t         *events,
+        void                   *object,
+        void                  (*pFunctSignal)(void *object, const CO_NMTevent_t *event))
+{
+    events->functSignalObject = object;
+    events->pFunctSignal = pFunctSignal;
+}
+
+
+/******************************************************************************/
+uint8_t CO_NMTevents_put(
+        CO_NMTevents_t         *events,
+        uint32_t                timestamp,
+        uint8_t                 type,
+        uint8_t                 nodeId,
+        uint8_t                 oldState,
+        uint8_t                 newState)
+{
+    CO_NMTevent_t *event;
+    uint8_t ret = 0;
+
+    DISABLE_INTERRUPTS();
+    if((uint8_t)(events->writeCnt - events->readCnt) < CO_NMT_EVENT_QUEUE_SIZE){
+        event = &events->buf[events->writeCnt & (CO_NMT_EVENT_QUEUE_SIZE-1)];
+        event->timestamp = timestamp;
+        event->type = type;
+        event->nodeId = nodeId;
+        event->oldState = oldState;
+        event->newState = newState;
+        events->writeCnt++;
+        ret = 1;
+    }
+    else{
+        if(events->overflow < 0xFFFF) events->overflow++;
+    }
+    ENABLE_INTERRUPTS();
+
+    return ret;
+}
+
+
+/******************************************************************************/
+uint8_t CO_NMTevents_get(CO_NMTevents_t *events, CO_NMTevent_t *event){
+    if(events->readCnt == events->writeCnt) return 0;
+
+    *event = events->buf[events->readCnt & (CO_NMT_EVENT_QUEUE_SIZE-1)];
+    events->readCnt++;
+
+    return 1;
+}
+
+
+/******************************************************************************/
+void CO_NMTevents_process(CO_NMTevents_t *events){
+    CO_NMTevent_t event;
+
+    if(events->pFunctSignal == 0) return;
+
+    while(CO_NMTevents_get(events, &event))
+        events->pFunctSignal(events->functSignalObject, &event);
+}
+
+
 /******************************************************************************/
 int16_t CO_NMT_init(
         CO_NMT_t               *NMT,
@@ -100,6 +195,9 @@ int16_t CO_NMT_init(
     NMT->resetCommand           = 0;
     NMT->HBproducerTimer        = 0xFFFF;
     NMT->EMpr                   = EMpr;
+    NMT->events                 = 0;
+    NMT->CANpassiveCount        = 0;
+    NMT->errorBehaviorCount     = 0;
 
     /* configure NMT CAN reception */
     CO_CANrxBufferInit(
@@ -125,6 +223,12 @@ int16_t CO_NMT_init(
 }
 
 
+/******************************************************************************/
+void CO_NMT_initEvents(CO_NMT_t *NMT, CO_NMTevents_t *events){
+    NMT->events = events;
+}
+
+
 /******************************************************************************/
 void CO_NMT_blinkingProcess50ms(CO_NMT_t *NMT){
 
@@ -176,7 +280,6 @@ uint8_t CO_NMT_process(
 
     /* Heartbeat producer message & Bootup message */
     if((HBtime && NMT->HBproducerTimer >= HBtime) || NMT->operatingState == CO_NMT_INITIALIZING){
-        printf("CO_NMT_process\r\n");
         NMT->HBproducerTimer = 0;
 
         NMT->HB_TXbuff->data[0] = NMT->operatingState;
@@ -186,8 +289,8 @@ uint8_t CO_NMT_process(
         if(NMT->operatingState == CO_NMT_INITIALIZING){
             if(HBtime > NMT->firstHBTime) NMT->HBproducerTimer = HBtime - NMT->firstHBTime;
 
-            if((NMTstartup & 0x04) == 0) NMT->operatingState = CO_NMT_OPERATIONAL;
-            else                         NMT->operatingState = CO_NMT_PRE_OPERATIONAL;
+            if((NMTstartup & 0x04) == 0) CO_NMT_setState(NMT, CO_NMT_OPERATIONAL);
+            else                         CO_NMT_setState(NMT, CO_NMT_PRE_OPERATIONAL);
         }
     }
 
@@ -195,7 +298,7 @@ uint8_t CO_NMT_process(
     /* CAN passive flag */
     CANpassive = 0;
     if(CO_isError(NMT->EMpr->EM, ERROR_CAN_TX_BUS_PASSIVE) || CO_isError(NMT->EMpr->EM, ERROR_CAN_RX_BUS_PASSIVE)){
-        printf("CANpassive!!\n\r");
+        NMT->CANpassiveCount++;
         CANpassive = 0; // HACK by Mike
     }
 
@@ -230,70 +333,58 @@ uint8_t CO_NMT_process(
     //printf(" 4\r\n");
     /* in case of error enter pre-operational state */
     if(errorBehavior && (NMT->operatingState == CO_NMT_OPERATIONAL)){
-        if(CANpassive && (errorBehavior[2] == 0 || errorBehavior[2] == 2)){
-          printf("CANpassive && (errorBehavior[2] == 0 || errorBehavior[2] == 2)\n\r");
-          errorRegister |= 0x10;
-        }
+        uint8_t state = CO_NMT_OPERATIONAL;
+
+        if(CANpassive && (errorBehavior[2] == 0 || errorBehavior[2] == 2)) errorRegister |= 0x10;
         
         if(errorRegister){
             /* Communication error */
             if(errorRegister&0x10){
                 if(errorBehavior[1] == 0){
-                    printf("errorBehavior[1] == 0\n\r");
-                    NMT->operatingState = CO_NMT_PRE_OPERATIONAL;
+                    state = CO_NMT_PRE_OPERATIONAL;
                 }
                 else if(errorBehavior[1] == 2){
-                    NMT->operatingState = CO_NMT_STOPPED;
+                    state = CO_NMT_STOPPED;
                 }
                 else if(CO_isError(NMT->EMpr->EM, ERROR_CAN_TX_BUS_OFF)
                      || CO_isError(NMT->EMpr->EM, ERROR_HEARTBEAT_CONSUMER)
                      || CO_isError(NMT->EMpr->EM, ERROR_HEARTBEAT_CONSUMER_REMOTE_RESET))
                 {
                     if(errorBehavior[0] == 0){
-                        printf("errorBehavior[0] == 0\n\r");
-                        NMT->operatingState = CO_NMT_PRE_OPERATIONAL;
+                        state = CO_NMT_PRE_OPERATIONAL;
                     }
                     else if(errorBehavior[0] == 2){
-                        NMT->operatingState = CO_NMT_STOPPED;
+                        state = CO_NMT_STOPPED;
                     }
                 }
             }
 
             /* Generic error */
             if(errorRegister&0x01){
-                if      (errorBehavior[3] == 0){
-                  printf("errorBehavior[3] == 0\n\r");
-                  NMT->operatingState = CO_NMT_PRE_OPERATIONAL;
-                }
-                else if (errorBehavior[3] == 2) NMT->operatingState = CO_NMT_STOPPED;
+                if      (errorBehavior[3] == 0) state = CO_NMT_PRE_OPERATIONAL;
+                else if (errorBehavior[3] == 2) state = CO_NMT_STOPPED;
             }
 
             /* Device profile error */
             if(errorRegister&0x20){
-                if      (errorBehavior[4] == 0){
-                  printf("errorBehavior[4] == 0\n\r");
-                  NMT->operatingState = CO_NMT_PRE_OPERATIONAL;
-                }
-                else if (errorBehavior[4] == 2) NMT->operatingState = CO_NMT_STOPPED;
+                if      (errorBehavior[4] == 0) state = CO_NMT_PRE_OPERATIONAL;
+                else if (errorBehavior[4] == 2) state = CO_NMT_STOPPED;
             }
 
             /* Manufacturer specific error */
             if(errorRegister&0x80){
-                if      (errorBehavior[5] == 0){
-                  printf("errorBehavior[5] == 0\n\r");
-                  NMT->operatingState = CO_NMT_PRE_OPERATIONAL;
-                }
-                else if (errorBehavior[5] == 2) NMT->operatingState = CO_NMT_STOPPED;
+                if      (errorBehavior[5] == 0) state = CO_NMT_PRE_OPERATIONAL;
+                else if (errorBehavior[5] == 2) state = CO_NMT_STOPPED;
             }
 
             /* if operational state is lost, send HB immediatelly. */
-            if(NMT->operatingState != CO_NMT_OPERATIONAL)
+            if(state != CO_NMT_OPERATIONAL){
+                NMT->errorBehaviorCount++;
+                CO_NMT_setState(NMT, state);
                 NMT->HBproducerTimer = HBtime;
+            }
         }
     }
 
-    if(NMT->resetCommand)
-      printf("NMT->resetCommand = 0x%X\r\n", NMT->resetCommand);
-      
     return NMT->resetCommand;
 }
@@ -27,6 +27,7 @@
 
 
 #include "CO_driver.h"
+#include "CO_timer.h"
 #include "CO_SDO.h"
 #include "CO_Emergency.h"
 #include "CO_NMT_Heartbeat.h"
@@ -38,6 +39,52 @@
 //extern int tpdo_send_count;
 //extern int sync_count;
 
+/*
+ * Save reception time of RPDO and update inter-arrival statistics.
+ *
+ * Function is called from CO_PDO_receive(), usually from interrupt.
+ */
+static void CO_RPDO_timestamp(CO_RPDO_t *RPDO){
+    uint32_t *statistics = RPDO->statistics;
+    uint32_t interval, jitter, n;
+
+    interval = getTime_us(&RPDO->rxTimestamp);
+    saveTime(&RPDO->rxTimestamp);
+
+    /* first RPDO after transition to NMT operational */
+    if(!RPDO->rxMonitored){
+        RPDO->rxMonitored = 1;
+        return;
+    }
+
+    if(statistics == 0) return;
+
+    if(statistics[0] > 0){
+        jitter = (interval > statistics[3]) ? (interval - statistics[3]) : (statistics[3] - interval);
+        if(jitter > statistics[4]) statistics[4] = jitter;
+    }
+
+    statistics[0]++;
+    if(interval < statistics[1]) statistics[1] = interval;
+    if(interval > statistics[2]) statistics[2] = interval;
+
+    /* moving average, first interval sets the mean */
+    n = (statistics[0] < CO_RPDO_STATISTICS_AVERAGE) ? statistics[0] : CO_RPDO_STATISTICS_AVERAGE;
+    if(interval >= statistics[3]) statistics[3] += (interval - statistics[3]) / n;
+    else                          statistics[3] -= (statistics[3] - interval) / n;
+}
+
+
+/*
+ * True, if RPDO is processed by receive interrupt. Only asynchronous RPDOs
+ * are, synchronous RPDOs are processed by CO_RPDO_process().
+ */
+static uint8_t CO_RPDO_isrMode(CO_RPDO_t *RPDO){
+    return (RPDO->pFunctRx && RPDO->callbackMode == CO_RPDO_CALLBACK_ISR
+            && RPDO->RPDOCommPar->transmissionType >= 254) ? 1 : 0;
+}
+
+
 /*
  * Read received message from CAN module.
  *
@@ -56,10 +103,16 @@ static int16_t CO_PDO_receive(void *object, CO_CANrxMsg_t *msg){
         /* verify message length */
         if(RPDO->dataLength && msg->DLC < RPDO->dataLength) return CO_ERROR_RX_PDO_LENGTH;
 
-        /* verify message overflow (previous message was not processed yet) */
-        if(RPDO->CANrxNew) return CO_ERROR_RX_PDO_OVERFLOW;
+        CO_RPDO_timestamp(RPDO);
+
+        /* previous message was not processed yet, overwrite it */
+        if(RPDO->CANrxNew){
+            RPDO->rxOverrun++;
+            if(RPDO->statistics && RPDO->statisticsSize > 6) RPDO->statistics[6]++;
+        }
 
-        /* copy data and set 'new message' flag */
+        /* copy data inside odd sequence and set 'new message' flag */
+        RPDO->CANrxSeq++;
         RPDO->CANrxData[0] = msg->data[0];
         RPDO->CANrxData[1] = msg->data[1];
         RPDO->CANrxData[2] = msg->data[2];
@@ -68,9 +121,18 @@ static int16_t CO_PDO_receive(void *object, CO_CANrxMsg_t *msg){
         RPDO->CANrxData[5] = msg->data[5];
         RPDO->CANrxData[6] = msg->data[6];
         RPDO->CANrxData[7] = msg->data[7];
+        RPDO->CANrxSeq++;
 
         RPDO->CANrxNew = 1;
 
+        /* application callback in receive context, mapped objects are written here */
+        if(CO_RPDO_isrMode(RPDO)){
+            int16_t i;
+            for(i=0; i<RPDO->dataLength; i++)
+                *RPDO->mapPointer[i] = msg->data[i];
+            RPDO->pFunctRx(RPDO->functRxObject, msg->data, RPDO->dataLength);
+        }
+
         /* verify message length */
         if(RPDO->dataLength && msg->DLC > RPDO->dataLength) return CO_ERROR_RX_PDO_LENGTH;
     }
@@ -82,6 +144,97 @@ static int16_t CO_PDO_receive(void *object, CO_CANrxMsg_t *msg){
 }
 
 
+/*
+ * Respond to remote transmission request for TPDO.
+ *
+ * Response is assembled and queued directly from the receive interrupt, so
+ * it follows the request without waiting for the mainline. Function is
+ * called from CAN receive interrupt. For more information and description
+ * of parameters see file CO_driver.h.
+ */
+static int16_t CO_TPDO_receiveRTR(void *object, CO_CANrxMsg_t *msg){
+    CO_TPDO_t *TPDO;
+    uint8_t transmissionType;
+
+    (void)msg;
+    TPDO = (CO_TPDO_t*)object;   /* this is the correct pointer type of the first argument */
+    transmissionType = TPDO->TPDOCommPar->transmissionType;
+
+    if(!TPDO->valid || *TPDO->operatingState != CO_NMT_OPERATIONAL)
+        return CO_ERROR_NO;
+
+    /* bit 30 of COB-ID: RTR is not allowed */
+    if(TPDO->TPDOCommPar->COB_IDUsedByTPDO & 0x40000000L)
+        return CO_ERROR_NO;
+
+    /* asynchronous RTR PDO, data are sampled now */
+    if(transmissionType == 253){
+        CO_TPDOsend(TPDO);
+    }
+    /* synchronous RTR PDO, send data sampled at the last SYNC */
+    else if(transmissionType == 252 && TPDO->latched){
+        int16_t i;
+
+        for(i=0; i<TPDO->dataLength; i++)
+            TPDO->CANtxBuff->data[i] = TPDO->latchData[i];
+        TPDO->CANtxBuff->DLC = TPDO->dataLength;
+        CO_CANsend(TPDO->CANdevTx, TPDO->CANtxBuff);
+    }
+
+    return CO_ERROR_NO;
+}
+
+
+/*
+ * Get CAN identifier of TPDO from Object dictionary.
+ */
+static uint16_t CO_TPDO_COB_ID(CO_TPDO_t *TPDO){
+    uint16_t ID = (uint16_t)(TPDO->TPDOCommPar->COB_IDUsedByTPDO & 0x7FF);
+
+    if(ID == TPDO->defaultCOB_ID) ID += TPDO->nodeId;
+    return ID;
+}
+
+
+/*
+ * Configure reception of remote transmission request for TPDO.
+ *
+ * Receive buffer from CO_TPDO_initRTR() accepts the RTR only for
+ * _transmission type_ 252 or 253, otherwise it is set to CAN identifier 0.
+ *
+ * @param TPDO This object.
+ * @param ID CAN identifier of the TPDO or 0, if TPDO is not valid.
+ * @param transmissionType New or actual _transmission type_.
+ *
+ * @return #CO_ReturnError_t from CO_CANrxBufferInit().
+ */
+static int16_t CO_TPDOconfigRTR(CO_TPDO_t* TPDO, uint16_t ID, uint8_t transmissionType){
+    if(TPDO->CANdevRx == 0) return CO_ERROR_NO;
+
+    if(transmissionType != 252 && transmissionType != 253) ID = 0;
+
+    return CO_CANrxBufferInit(
+            TPDO->CANdevRx,         /* CAN device */
+            TPDO->CANdevRxIdx,      /* rx buffer index */
+            ID,                     /* CAN identifier */
+            0x7FF,                  /* mask */
+            1,                      /* rtr */
+            (void*)TPDO,            /* object passed to receive function */
+            CO_TPDO_receiveRTR);    /* this function will process received message */
+}
+
+
+/*
+ * Return true, if ID is the first identifier of a block of allocated COB-IDs.
+ * Such value in Object dictionary means default COB-ID of additional PDO,
+ * see CO_PDO_defaultCOB_ID().
+ */
+static uint8_t CO_PDO_isAllocBase(uint16_t ID){
+    if(ID < CO_PDO_ALLOC_BASE || ID + CO_PDO_ALLOC_MAX_NODE_ID > CO_PDO_ALLOC_LAST) return 0;
+    return ((ID - CO_PDO_ALLOC_BASE) % CO_PDO_ALLOC_MAX_NODE_ID == 0) ? 1 : 0;
+}
+
+
 /*
  * Configure RPDO Communication parameter.
  *
@@ -101,6 +254,12 @@ static void CO_RPDOconfigCom(CO_RPDO_t* RPDO, uint32_t COB_IDUsedByRPDO){
 
     ID = (uint16_t)COB_IDUsedByRPDO;
 
+    /* allocated default COB-ID, which does not exist, would overlap */
+    if((COB_IDUsedByRPDO & 0x80000000L) == 0 && ID != RPDO->defaultCOB_ID && CO_PDO_isAllocBase(ID)){
+        CO_errorReport(RPDO->EM, ERROR_PDO_NO_COB_ID, ID);
+        ID = 0;
+    }
+
     /* is RPDO used? */
     if((COB_IDUsedByRPDO & 0xBFFFF800L) == 0 && RPDO->dataLength && ID){
         /* is used default COB-ID? */
@@ -146,6 +305,12 @@ static void CO_TPDOconfigCom(CO_TPDO_t* TPDO, uint32_t COB_IDUsedByTPDO, uint8_t
 
     ID = (uint16_t)COB_IDUsedByTPDO;
 
+    /* allocated default COB-ID, which does not exist, would overlap */
+    if((COB_IDUsedByTPDO & 0x80000000L) == 0 && ID != TPDO->defaultCOB_ID && CO_PDO_isAllocBase(ID)){
+        CO_errorReport(TPDO->EM, ERROR_PDO_NO_COB_ID, ID);
+        ID = 0;
+    }
+
     /* is TPDO used? */
     if((COB_IDUsedByTPDO & 0xBFFFF800L) == 0 && TPDO->dataLength && ID){
         /* is used default COB-ID? */
@@ -168,6 +333,9 @@ static void CO_TPDOconfigCom(CO_TPDO_t* TPDO, uint32_t COB_IDUsedByTPDO, uint8_t
     if(TPDO->CANtxBuff == 0){
         TPDO->valid = 0;
     }
+
+    /* remote transmission request, see CO_TPDO_initRTR() */
+    CO_TPDOconfigRTR(TPDO, ID, TPDO->TPDOCommPar->transmissionType);
 }
 
 
@@ -277,44 +445,58 @@ static uint32_t CO_PDOfindMap(
 
 
 /*
- * Configure RPDO Mapping parameter.
- *
- * Function is called from communication reset or when parameter changes.
+ * Build PDO mapping.
  *
- * Function configures following variables from CO_RPDO_t: _dataLength_ and
- * _mapPointer_.
+ * Function is used for mapping from Object dictionary and for shadow mapping.
+ * Mapping is written into given arrays, so it may be prepared aside from the
+ * active mapping.
  *
- * @param RPDO RPDO object.
- * @param noOfMappedObjects Number of mapped object (from OD).
+ * @param SDO SDO object.
+ * @param R_T 0 for RPDO map, 1 for TPDO map.
+ * @param pMap Pointer to the first mapped object (mappedObject1).
+ * @param noOfMappedObjects Number of mapped objects.
+ * @param mapPointer Array of 8 pointers to mapped data bytes, written here.
+ * @param pLength Data length of the PDO, written here. Zero on error.
+ * @param pSendIfCOSFlags Change of State flags, written here.
+ * @param pErrMap Map, which caused the error, written here.
  *
  * @return 0 on success, otherwise SDO abort code.
  */
-static uint32_t CO_RPDOconfigMap(CO_RPDO_t* RPDO, uint8_t noOfMappedObjects){
+static uint32_t CO_PDObuildMap(
+        CO_SDO_t               *SDO,
+        uint8_t                 R_T,
+        const uint32_t         *pMap,
+        uint8_t                 noOfMappedObjects,
+        uint8_t               **mapPointer,
+        uint8_t                *pLength,
+        uint8_t                *pSendIfCOSFlags,
+        uint32_t               *pErrMap)
+{
     int16_t i;
     uint8_t length = 0;
     uint32_t ret = 0;
-    const uint32_t* pMap = &RPDO->RPDOMapPar->mappedObject1;
+
+    *pSendIfCOSFlags = 0;
 
     for(i=noOfMappedObjects; i>0; i--){
         int16_t j;
         uint8_t* pData;
-        uint8_t dummy = 0;
         uint8_t prevLength = length;
         uint8_t MBvar;
         uint32_t map = *(pMap++);
 
         /* function do much checking of errors in map */
         ret = CO_PDOfindMap(
-                RPDO->SDO,
+                SDO,
                 map,
-                0,
+                R_T,
                 &pData,
                 &length,
-                &dummy,
+                pSendIfCOSFlags,
                 &MBvar);
         if(ret){
             length = 0;
-            CO_errorReport(RPDO->EM, ERROR_PDO_WRONG_MAPPING, map);
+            *pErrMap = map;
             break;
         }
 
@@ -322,21 +504,54 @@ static uint32_t CO_RPDOconfigMap(CO_RPDO_t* RPDO, uint8_t noOfMappedObjects){
 #ifdef BIG_ENDIAN
         if(MBvar){
             for(j=length-1; j>=prevLength; j--)
-                RPDO->mapPointer[j] = pData++;
+                mapPointer[j] = pData++;
         }
         else{
             for(j=prevLength; j<length; j++)
-                RPDO->mapPointer[j] = pData++;
+                mapPointer[j] = pData++;
         }
 #else
         for(j=prevLength; j<length; j++){
-            RPDO->mapPointer[j] = pData++;
+            mapPointer[j] = pData++;
         }
 #endif
 
     }
 
-    RPDO->dataLength = length;
+    *pLength = length;
+
+    return ret;
+}
+
+
+/*
+ * Configure RPDO Mapping parameter.
+ *
+ * Function is called from communication reset or when parameter changes.
+ *
+ * Function configures following variables from CO_RPDO_t: _dataLength_ and
+ * _mapPointer_.
+ *
+ * @param RPDO RPDO object.
+ * @param noOfMappedObjects Number of mapped object (from OD).
+ *
+ * @return 0 on success, otherwise SDO abort code.
+ */
+static uint32_t CO_RPDOconfigMap(CO_RPDO_t* RPDO, uint8_t noOfMappedObjects){
+    uint32_t ret;
+    uint32_t map;
+    uint8_t dummy;
+
+    ret = CO_PDObuildMap(
+            RPDO->SDO,
+            0,
+            &RPDO->RPDOMapPar->mappedObject1,
+            noOfMappedObjects,
+            RPDO->mapPointer,
+            &RPDO->dataLength,
+            &dummy,
+            &map);
+    if(ret) CO_errorReport(RPDO->EM, ERROR_PDO_WRONG_MAPPING, map);
 
     return ret;
 }
@@ -356,54 +571,19 @@ static uint32_t CO_RPDOconfigMap(CO_RPDO_t* RPDO, uint8_t noOfMappedObjects){
  * @return 0 on success, otherwise SDO abort code.
  */
 static uint32_t CO_TPDOconfigMap(CO_TPDO_t* TPDO, uint8_t noOfMappedObjects){
-    int16_t i;
-    uint8_t length = 0;
-    uint32_t ret = 0;
-    const uint32_t* pMap = &TPDO->TPDOMapPar->mappedObject1;
-
-    TPDO->sendIfCOSFlags = 0;
-
-    for(i=noOfMappedObjects; i>0; i--){
-        int16_t j;
-        uint8_t* pData;
-        uint8_t prevLength = length;
-        uint8_t MBvar;
-        uint32_t map = *(pMap++);
-
-        /* function do much checking of errors in map */
-        ret = CO_PDOfindMap(
-                TPDO->SDO,
-                map,
-                1,
-                &pData,
-                &length,
-                &TPDO->sendIfCOSFlags,
-                &MBvar);
-        if(ret){
-            length = 0;
-            CO_errorReport(TPDO->EM, ERROR_PDO_WRONG_MAPPING, map);
-            break;
-        }
-
-        /* write PDO data pointers */
-#ifdef BIG_ENDIAN
-        if(MBvar){
-            for(j=length-1; j>=prevLength; j--)
-                TPDO->mapPointer[j] = pData++;
-        }
-        else{
-            for(j=prevLength; j<length; j++)
-                TPDO->mapPointer[j] = pData++;
-        }
-#else
-        for(j=prevLength; j<length; j++){
-            TPDO->mapPointer[j] = pData++;
-        }
-#endif
-
-    }
-
-    TPDO->dataLength = length;
+    uint32_t ret;
+    uint32_t map;
+
+    ret = CO_PDObuildMap(
+            TPDO->SDO,
+            1,
+            &TPDO->TPDOMapPar->mappedObject1,
+            noOfMappedObjects,
+            TPDO->mapPointer,
+            &TPDO->dataLength,
+            &TPDO->sendIfCOSFlags,
+            &map);
+    if(ret) CO_errorReport(TPDO->EM, ERROR_PDO_WRONG_MAPPING, map);
 
     return ret;
 }
@@ -529,11 +709,14 @@ static uint32_t CO_ODF_TPDOcom(CO_ODF_arg_t *ODF_arg){
     else if(ODF_arg->subIndex == 2){   /* Transmission_type */
         uint8_t *value = (uint8_t*) ODF_arg->data;
 
-        /* values from 241...253 are not valid */
-        if(*value >= 241 && *value <= 253)
+        /* values from 241...251 are not valid */
+        if(*value >= 241 && *value <= 251)
             return 0x06090030L;  /* Invalid value for parameter (download only). */
         TPDO->CANtxBuff->syncFlag = (*value <= 240) ? 1 : 0;
         TPDO->syncCounter = 255;
+        TPDO->groupLatched = 0;
+        TPDO->latched = 0;
+        CO_TPDOconfigRTR(TPDO, TPDO->valid ? CO_TPDO_COB_ID(TPDO) : 0, *value);
     }
     else if(ODF_arg->subIndex == 3){   /* Inhibit_Time */
         /* if PDO is valid, value can not be changed */
@@ -541,11 +724,21 @@ static uint32_t CO_ODF_TPDOcom(CO_ODF_arg_t *ODF_arg){
             return 0x06090030L;  /* Invalid value for parameter (download only). */
 
         TPDO->inhibitTimer = 0;
+#if CO_TPDO_HIGH_RES == 1
+        TPDO->inhibitDeadline = getTimeNow_us();
+#endif
     }
     else if(ODF_arg->subIndex == 5){   /* Event_Timer */
         uint16_t *value = (uint16_t*) ODF_arg->data;
 
         TPDO->eventTimer = *value;
+#if CO_TPDO_HIGH_RES == 1
+        /* event period in microseconds from CO_TPDO_initHighRes() has priority */
+        if(TPDO->eventTime_us && *TPDO->eventTime_us)
+            TPDO->eventDeadline = getTimeNow_us() + *TPDO->eventTime_us;
+        else
+            TPDO->eventDeadline = getTimeNow_us() + (uint32_t)*value * 1000;
+#endif
     }
     else if(ODF_arg->subIndex == 6){   /* SYNC start value */
         uint8_t *value = (uint8_t*) ODF_arg->data;
@@ -589,8 +782,54 @@ static uint32_t CO_ODF_RPDOmap(CO_ODF_arg_t *ODF_arg){
         return 0x06010002L;  /* Attempt to write a read only object. */
     if(*RPDO->operatingState == CO_NMT_OPERATIONAL && (RPDO->restrictionFlags & 0x02))
         return 0x08000022L;   /* Data cannot be transferred or stored to the application because of the present device state. */
-    if(RPDO->valid)
-        return 0x06090030L;  /* Invalid value for parameter (download only). */
+
+    /* Valid PDO keeps working, mapping is written into shadow record and
+    swapped in later, see @ref CO_PDO. Object dictionary keeps the active
+    mapping until then. */
+    if(RPDO->valid){
+        CO_RPDOMapPar_t *rec = &RPDO->shadowRecord;
+        const uint8_t *ODdata = (const uint8_t*) ODF_arg->ODdataStorage;
+        uint32_t ret = 0;
+        uint16_t i;
+
+        if(ODF_arg->subIndex == 0){
+            uint8_t *value = (uint8_t*) ODF_arg->data;
+
+            if(*value > 8)
+                return 0x06090031L;  /* Value of parameter written too high. */
+
+            if(*value == 0){
+                /* start writing new mapping, discard prepared mapping */
+                *rec = *RPDO->RPDOMapPar;
+                rec->numberOfMappedObjects = 0;
+                RPDO->shadowPending = 0;
+            }
+            else{
+                if(rec->numberOfMappedObjects != 0)
+                    return 0x06090030L;  /* Invalid value for parameter (download only). */
+                rec->numberOfMappedObjects = *value;
+                ret = CO_RPDO_prepareMap(RPDO, rec);
+                if(ret) rec->numberOfMappedObjects = 0;
+            }
+        }
+        else{
+            uint32_t *value = (uint32_t*) ODF_arg->data;
+            uint8_t* pData;
+            uint8_t length = 0;
+            uint8_t dummy = 0;
+            uint8_t MBvar;
+
+            if(rec->numberOfMappedObjects != 0)
+                return 0x06090030L;  /* Invalid value for parameter (download only). */
+
+            ret = CO_PDOfindMap(RPDO->SDO, *value, 0, &pData, &length, &dummy, &MBvar);
+            if(!ret) (&rec->mappedObject1)[ODF_arg->subIndex - 1] = *value;
+        }
+        if(ret) return ret;
+
+        for(i=0; i<ODF_arg->dataLength; i++) ODF_arg->data[i] = ODdata[i];
+        return 0;
+    }
 
     /* numberOfMappedObjects */
     if(ODF_arg->subIndex == 0){
@@ -655,8 +894,54 @@ static uint32_t CO_ODF_TPDOmap(CO_ODF_arg_t *ODF_arg){
         return 0x06010002L;  /* Attempt to write a read only object. */
     if(*TPDO->operatingState == CO_NMT_OPERATIONAL && (TPDO->restrictionFlags & 0x02))
         return 0x08000022L;   /* Data cannot be transferred or stored to the application because of the present device state. */
-    if(TPDO->valid)
-        return 0x06090030L;  /* Invalid value for parameter (download only). */
+
+    /* Valid PDO keeps working, mapping is written into shadow record and
+    swapped in later, see @ref CO_PDO. Object dictionary keeps the active
+    mapping until then. */
+    if(TPDO->valid){
+        CO_TPDOMapPar_t *rec = &TPDO->shadowRecord;
+        const uint8_t *ODdata = (const uint8_t*) ODF_arg->ODdataStorage;
+        uint32_t ret = 0;
+        uint16_t i;
+
+        if(ODF_arg->subIndex == 0){
+            uint8_t *value = (uint8_t*) ODF_arg->data;
+
+            if(*value > 8)
+                return 0x06090031L;  /* Value of parameter written too high. */
+
+            if(*value == 0){
+                /* start writing new mapping, discard prepared mapping */
+                *rec = *TPDO->TPDOMapPar;
+                rec->numberOfMappedObjects = 0;
+                TPDO->shadowPending = 0;
+            }
+            else{
+                if(rec->numberOfMappedObjects != 0)
+                    return 0x06090030L;  /* Invalid value for parameter (download only). */
+                rec->numberOfMappedObjects = *value;
+                ret = CO_TPDO_prepareMap(TPDO, rec);
+                if(ret) rec->numberOfMappedObjects = 0;
+            }
+        }
+        else{
+            uint32_t *value = (uint32_t*) ODF_arg->data;
+            uint8_t* pData;
+            uint8_t length = 0;
+            uint8_t dummy = 0;
+            uint8_t MBvar;
+
+            if(rec->numberOfMappedObjects != 0)
+                return 0x06090030L;  /* Invalid value for parameter (download only). */
+
+            ret = CO_PDOfindMap(TPDO->SDO, *value, 1, &pData, &length, &dummy, &MBvar);
+            if(!ret) (&rec->mappedObject1)[ODF_arg->subIndex - 1] = *value;
+        }
+        if(ret) return ret;
+
+        for(i=0; i<ODF_arg->dataLength; i++) ODF_arg->data[i] = ODdata[i];
+        return 0;
+    }
 
     /* numberOfMappedObjects */
     if(ODF_arg->subIndex == 0){
@@ -695,6 +980,56 @@ static uint32_t CO_ODF_TPDOmap(CO_ODF_arg_t *ODF_arg){
 }
 
 
+/*
+ * Clear RPDO inter-arrival statistics.
+ */
+static void CO_RPDO_statisticsClear(CO_RPDO_t *RPDO){
+    uint8_t i;
+
+    DISABLE_INTERRUPTS();
+    for(i=0; i<RPDO->statisticsSize; i++) RPDO->statistics[i] = 0;
+    RPDO->statistics[1] = 0xFFFFFFFFL;
+    ENABLE_INTERRUPTS();
+}
+
+
+/*
+ * Function for accessing RPDO inter-arrival statistics from SDO server.
+ *
+ * Writing any value clears the statistics. For more information see file
+ * CO_SDO.h.
+ */
+static uint32_t CO_ODF_RPDOstatistics(CO_ODF_arg_t *ODF_arg){
+    CO_RPDO_t *RPDO;
+
+    RPDO = (CO_RPDO_t*) ODF_arg->object;
+
+    if(!ODF_arg->reading && ODF_arg->subIndex > 0){
+        uint8_t *cleared;
+        uint8_t i;
+
+        CO_RPDO_statisticsClear(RPDO);
+
+        /* written value will be copied to Object dictionary, replace it */
+        cleared = (uint8_t*) &RPDO->statistics[ODF_arg->subIndex - 1];
+        for(i=0; i<4; i++) ODF_arg->data[i] = cleared[i];
+    }
+
+    return 0;
+}
+
+
+/*
+ * Return COB-ID of the RPDO, with node-ID added, if default COB-ID is used.
+ */
+static uint16_t CO_RPDO_COB_ID(CO_RPDO_t *RPDO){
+    uint16_t ID = (uint16_t)(RPDO->RPDOCommPar->COB_IDUsedByRPDO & 0x7FF);
+
+    if(ID == RPDO->defaultCOB_ID) ID += RPDO->nodeId;
+    return ID;
+}
+
+
 /******************************************************************************/
 int16_t CO_RPDO_init(
         CO_RPDO_t              *RPDO,
@@ -728,6 +1063,19 @@ int16_t CO_RPDO_init(
 
     /* configure communication and mapping */
     RPDO->CANrxNew = 0;
+    RPDO->CANrxSeq = 0;
+    RPDO->rxOverrun = 0;
+    RPDO->pFunctRx = 0;
+    RPDO->functRxObject = 0;
+    RPDO->callbackMode = CO_RPDO_CALLBACK_DEFERRED;
+    RPDO->rxMonitored = 0;
+    RPDO->rxTimeout = 0;
+    RPDO->statistics = 0;
+    RPDO->statisticsSize = 0;
+    RPDO->shadowMapPar = 0;
+    RPDO->shadowPending = 0;
+    RPDO->shadowRecord.numberOfMappedObjects = 0xFF;
+    saveTime(&RPDO->rxTimestamp);
     RPDO->CANdevRx = CANdevRx;
     RPDO->CANdevRxIdx = CANdevRxIdx;
 
@@ -738,6 +1086,79 @@ int16_t CO_RPDO_init(
 }
 
 
+/*
+ * Update SYNC to TPDO latency statistics.
+ *
+ * Function is called by CAN driver, when TPDO message is copied to CAN
+ * mailbox or dropped, see CO_CANtx_t in CO_driver.h.
+ */
+static void CO_TPDO_latencyUpdate(void *object, uint8_t dropped){
+    CO_TPDO_t *TPDO;
+    uint32_t *latency;
+    uint32_t time, bin;
+
+    TPDO = (CO_TPDO_t*)object;
+    latency = TPDO->latency;
+
+    /* only synchronous TPDOs are measured */
+    if(TPDO->TPDOCommPar->transmissionType > 240) return;
+
+    if(dropped){
+        latency[3]++;
+        return;
+    }
+
+    time = getTime_us(&TPDO->SYNC->timestamp);
+
+    latency[0]++;
+    if(time < latency[1]) latency[1] = time;
+    if(time > latency[2]) latency[2] = time;
+
+    bin = time / CO_TPDO_LATENCY_BIN_WIDTH;
+    if(bin > (uint32_t)(TPDO->latencySize - 5)) bin = TPDO->latencySize - 5;
+    latency[4 + bin]++;
+}
+
+
+/*
+ * Clear SYNC to TPDO latency statistics.
+ */
+static void CO_TPDO_latencyClear(CO_TPDO_t *TPDO){
+    uint8_t i;
+
+    DISABLE_INTERRUPTS();
+    for(i=0; i<TPDO->latencySize; i++) TPDO->latency[i] = 0;
+    TPDO->latency[1] = 0xFFFFFFFFL;
+    ENABLE_INTERRUPTS();
+}
+
+
+/*
+ * Function for accessing SYNC to TPDO latency statistics from SDO server.
+ *
+ * Writing any value clears the statistics. For more information see file
+ * CO_SDO.h.
+ */
+static uint32_t CO_ODF_TPDOlatency(CO_ODF_arg_t *ODF_arg){
+    CO_TPDO_t *TPDO;
+
+    TPDO = (CO_TPDO_t*) ODF_arg->object;
+
+    if(!ODF_arg->reading && ODF_arg->subIndex > 0){
+        uint8_t *cleared;
+        uint8_t i;
+
+        CO_TPDO_latencyClear(TPDO);
+
+        /* written value will be copied to Object dictionary, replace it */
+        cleared = (uint8_t*) &TPDO->latency[ODF_arg->subIndex - 1];
+        for(i=0; i<4; i++) ODF_arg->data[i] = cleared[i];
+    }
+
+    return 0;
+}
+
+
 /******************************************************************************/
 int16_t CO_TPDO_init(
         CO_TPDO_t              *TPDO,
@@ -772,17 +1193,35 @@ int16_t CO_TPDO_init(
     /* configure communication and mapping */
     TPDO->CANdevTx = CANdevTx;
     TPDO->CANdevTxIdx = CANdevTxIdx;
+    TPDO->CANdevRx = 0;
+    TPDO->CANdevRxIdx = 0;
     TPDO->syncCounter = 255;
     TPDO->inhibitTimer = 0;
     TPDO->eventTimer = TPDOCommPar->eventTimer;
-    TPDO->SYNCtimerPrevious = 0;
+    TPDO->eventPhase = 0;
+#if CO_TPDO_HIGH_RES == 1
+    TPDO->eventTime_us = 0;
+    TPDO->eventDeadline = getTimeNow_us();
+    TPDO->inhibitDeadline = TPDO->eventDeadline;
+#endif
+    TPDO->SYNC = 0;
+    TPDO->latency = 0;
+    TPDO->latencySize = 0;
+    TPDO->SYNCoffset = 0;
+    TPDO->SYNCpending = 0;
+    TPDO->group = 0;
+    TPDO->groupLatched = 0;
+    TPDO->latched = 0;
+    TPDO->shadowMapPar = 0;
+    TPDO->shadowPending = 0;
+    TPDO->shadowRecord.numberOfMappedObjects = 0xFF;
     if(TPDOCommPar->transmissionType>=254) TPDO->sendRequest = 1;
 
     CO_TPDOconfigMap(TPDO, TPDOMapPar->numberOfMappedObjects);
     CO_TPDOconfigCom(TPDO, TPDOCommPar->COB_IDUsedByTPDO, ((TPDOCommPar->transmissionType<=240) ? 1 : 0));
 
     if((TPDOCommPar->transmissionType>240 &&
-         TPDOCommPar->transmissionType<254) ||
+         TPDOCommPar->transmissionType<252) ||
          TPDOCommPar->SYNCStartValue>240){
             TPDO->valid = 0;
     }
@@ -792,11 +1231,276 @@ int16_t CO_TPDO_init(
 
 
 /******************************************************************************/
-uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO){
+int16_t CO_RPDO_initStatistics(
+        CO_RPDO_t              *RPDO,
+        CO_SDO_t               *SDO,
+        uint32_t               *statistics,
+        uint8_t                 statisticsSize,
+        uint16_t                index)
+{
+    /* verify arguments */
+    if(statistics == 0 || statisticsSize < 6) return CO_ERROR_ILLEGAL_ARGUMENT;
 
-    /* Prepare TPDO data automatically from Object Dictionary variables */
-    uint8_t* pPDOdataByte;
-    uint8_t** ppODdataByte;
+    RPDO->statistics = statistics;
+    RPDO->statisticsSize = statisticsSize;
+    CO_RPDO_statisticsClear(RPDO);
+
+    CO_OD_configure(SDO, index, CO_ODF_RPDOstatistics, (void*)RPDO, 0, 0);
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+int16_t CO_RPDO_initCallback(
+        CO_RPDO_t              *RPDO,
+        void                   *object,
+        void                  (*pFunctRx)(void *object, const uint8_t *data, uint8_t dataLength),
+        uint8_t                 callbackMode)
+{
+    /* verify arguments */
+    if(callbackMode != CO_RPDO_CALLBACK_DEFERRED && callbackMode != CO_RPDO_CALLBACK_ISR)
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    DISABLE_INTERRUPTS();
+    RPDO->pFunctRx = pFunctRx;
+    RPDO->functRxObject = object;
+    RPDO->callbackMode = callbackMode;
+    ENABLE_INTERRUPTS();
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+int16_t CO_TPDO_initLatency(
+        CO_TPDO_t              *TPDO,
+        CO_SDO_t               *SDO,
+        CO_SYNC_t              *SYNC,
+        uint32_t               *latency,
+        uint8_t                 latencySize,
+        uint16_t                index)
+{
+    /* verify arguments */
+    if(SYNC == 0 || latency == 0 || latencySize < 5 || TPDO->CANtxBuff == 0)
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    TPDO->SYNC = SYNC;
+    TPDO->latency = latency;
+    TPDO->latencySize = latencySize;
+    CO_TPDO_latencyClear(TPDO);
+
+    /* CAN driver reports, when TPDO is copied to CAN mailbox */
+    TPDO->CANtxBuff->object = (void*)TPDO;
+    TPDO->CANtxBuff->pFunctHandOff = CO_TPDO_latencyUpdate;
+
+    CO_OD_configure(SDO, index, CO_ODF_TPDOlatency, (void*)TPDO, 0, 0);
+
+    return CO_ERROR_NO;
+}
+
+
+/*
+ * Function for accessing _TPDO transmit offset_ array from SDO server.
+ *
+ * Offset must be smaller than SYNC period, otherwise TPDO would never be sent.
+ *
+ * For more information see file CO_SDO.h.
+ */
+static uint32_t CO_ODF_TPDOSYNCoffset(CO_ODF_arg_t *ODF_arg){
+    CO_SYNC_t *SYNC = (CO_SYNC_t*) ODF_arg->object;
+
+    if(!ODF_arg->reading && ODF_arg->subIndex > 0){
+        uint32_t *value = (uint32_t*) ODF_arg->data;
+
+        if(SYNC->periodTime && *value >= SYNC->periodTime)
+            return 0x06090031L;  /* Value of parameter written too high. */
+    }
+
+    return 0;
+}
+
+
+/******************************************************************************/
+int16_t CO_TPDO_initSYNCoffset(
+        CO_TPDO_t              *TPDO,
+        CO_SDO_t               *SDO,
+        CO_SYNC_t              *SYNC,
+        const uint32_t         *SYNCoffset,
+        uint16_t                index)
+{
+    /* verify arguments */
+    if(SYNC == 0 || SYNCoffset == 0) return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    TPDO->SYNC = SYNC;
+    TPDO->SYNCoffset = SYNCoffset;
+
+    /* array is shared by all TPDOs, SYNC object is the same for all */
+    CO_OD_configure(SDO, index, CO_ODF_TPDOSYNCoffset, (void*)SYNC, 0, 0);
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+int16_t CO_TPDO_initGroup(
+        CO_TPDO_t              *TPDO,
+        const uint8_t          *group)
+{
+    /* verify arguments */
+    if(group == 0) return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    TPDO->group = group;
+    TPDO->groupLatched = 0;
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+uint16_t CO_PDO_defaultCOB_ID(uint16_t pdoNo, uint8_t R_T, uint8_t nodeId){
+    uint32_t ID;
+
+    /* predefined connection set */
+    if(pdoNo < 4){
+        return (R_T ? 0x180 : 0x200) + pdoNo*0x100;
+    }
+
+    /* one block of CO_PDO_ALLOC_MAX_NODE_ID identifiers for each TPDO and RPDO */
+    if(nodeId == 0 || nodeId > CO_PDO_ALLOC_MAX_NODE_ID) return 0;
+    ID = CO_PDO_ALLOC_BASE + ((uint32_t)(pdoNo-4)*2 + (R_T ? 0 : 1)) * CO_PDO_ALLOC_MAX_NODE_ID;
+    if(ID + CO_PDO_ALLOC_MAX_NODE_ID > CO_PDO_ALLOC_LAST) return 0;
+
+    return (uint16_t)ID;
+}
+
+
+/*
+ * Verify received CAN message, which was not accepted by any other object.
+ *
+ * If identifier is the default COB-ID of own TPDO, another producer uses it.
+ * TPDO index is calculated from identifier, so function takes constant time.
+ * Function is called from CAN receive interrupt. For more information and
+ * description of parameters see file CO_driver.h.
+ */
+static int16_t CO_TPDOmonitor_receive(void *object, CO_CANrxMsg_t *msg){
+    CO_TPDOmonitor_t *TM;
+    CO_TPDO_t *TPDO;
+    uint16_t ID;
+    uint16_t i = 0xFFFF;
+
+    TM = (CO_TPDOmonitor_t*)object;   /* this is the correct pointer type of the first argument */
+    ID = CO_CANrxMsg_readIdent(msg);
+
+    /* predefined connection set: 0x180, 0x280, 0x380, 0x480 (+nodeID) */
+    if((ID & 0x7F) == TM->nodeId && (ID & 0x80) && ID >= 0x180 && ID < 0x500){
+        i = (ID - 0x180) >> 8;
+    }
+    /* allocated identifiers, even blocks are for TPDOs */
+    else if(ID > CO_PDO_ALLOC_BASE && ID <= CO_PDO_ALLOC_LAST){
+        uint16_t offset = ID - CO_PDO_ALLOC_BASE - 1;
+        uint16_t block = offset / CO_PDO_ALLOC_MAX_NODE_ID;
+
+        if((offset % CO_PDO_ALLOC_MAX_NODE_ID) + 1 == TM->nodeId && (block & 1) == 0)
+            i = 4 + block / 2;
+    }
+
+    if(i >= TM->noOfTPDO) return CO_ERROR_NO;
+
+    TPDO = TM->TPDO[i];
+    if(TPDO->valid && CO_TPDO_COB_ID(TPDO) == ID){
+        /* two producers of the same PDO corrupt the bus, stop own TPDO */
+        TPDO->valid = 0;
+        TM->conflictCOB_ID = ID;
+        CO_errorReport(TM->EM, ERROR_TPDO_COB_ID_CONFLICT, ID);
+    }
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+int16_t CO_TPDOmonitor_init(
+        CO_TPDOmonitor_t       *TM,
+        CO_EM_t                *EM,
+        CO_TPDO_t              *TPDO[],
+        uint16_t                noOfTPDO,
+        uint8_t                 nodeId,
+        CO_CANmodule_t         *CANdevRx,
+        uint16_t                CANdevRxIdx)
+{
+    /* verify arguments */
+    if(TPDO == 0 || nodeId < 1 || nodeId > 127) return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    TM->EM = EM;
+    TM->TPDO = TPDO;
+    TM->noOfTPDO = noOfTPDO;
+    TM->nodeId = nodeId;
+    TM->conflictCOB_ID = 0;
+
+    /* accept all data frames, buffer must be the last one in rxArray */
+    return CO_CANrxBufferInit(
+            CANdevRx,               /* CAN device */
+            CANdevRxIdx,            /* rx buffer index */
+            0,                      /* CAN identifier */
+            0,                      /* mask */
+            0,                      /* rtr */
+            (void*)TM,              /* object passed to receive function */
+            CO_TPDOmonitor_receive);/* this function will process received message */
+}
+
+
+/******************************************************************************/
+int16_t CO_TPDO_initRTR(
+        CO_TPDO_t              *TPDO,
+        CO_CANmodule_t         *CANdevRx,
+        uint16_t                CANdevRxIdx)
+{
+    /* verify arguments */
+    if(CANdevRx == 0) return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    TPDO->CANdevRx = CANdevRx;
+    TPDO->CANdevRxIdx = CANdevRxIdx;
+
+    return CO_TPDOconfigRTR(
+            TPDO,
+            TPDO->valid ? CO_TPDO_COB_ID(TPDO) : 0,
+            TPDO->TPDOCommPar->transmissionType);
+}
+
+
+#if CO_TPDO_HIGH_RES == 1
+/******************************************************************************/
+int16_t CO_TPDO_initHighRes(
+        CO_TPDO_t              *TPDO,
+        const uint32_t         *eventTime_us)
+{
+    /* verify arguments */
+    if(eventTime_us == 0) return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    TPDO->eventTime_us = eventTime_us;
+
+    return CO_ERROR_NO;
+}
+
+
+/*
+ * Get event period of TPDO in [microseconds], zero if not used.
+ */
+static uint32_t CO_TPDO_eventPeriod_us(CO_TPDO_t *TPDO){
+    if(TPDO->eventTime_us && *TPDO->eventTime_us)
+        return *TPDO->eventTime_us;
+    return (uint32_t)TPDO->TPDOCommPar->eventTimer * 1000;
+}
+#endif
+
+
+/******************************************************************************/
+uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO){
+
+    /* Prepare TPDO data automatically from Object Dictionary variables */
+    uint8_t* pPDOdataByte;
+    uint8_t** ppODdataByte;
 
     pPDOdataByte = &TPDO->CANtxBuff->data[TPDO->dataLength];
     ppODdataByte = &TPDO->mapPointer[TPDO->dataLength];
@@ -816,55 +1520,376 @@ uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO){
 }
 
 
+/*
+ * Copy mapped objects of TPDO into latchData (sampled at SYNC) or into
+ * groupData. Must be called with interrupts disabled.
+ */
+static void CO_TPDO_latch(CO_TPDO_t *TPDO, uint8_t toGroup){
+    uint8_t *data = toGroup ? TPDO->groupData : TPDO->latchData;
+    int16_t i;
+
+    for(i=0; i<TPDO->dataLength; i++)
+        data[i] = *TPDO->mapPointer[i];
+    if(toGroup) TPDO->groupLatched = 1;
+    else        TPDO->latched = 1;
+}
+
+
+/******************************************************************************/
+uint8_t CO_TPDOisSYNC(CO_TPDO_t *TPDO, CO_SYNC_t *SYNC){
+
+    if(!TPDO->valid || *TPDO->operatingState != CO_NMT_OPERATIONAL)
+        return 0;
+
+    if(TPDO->TPDOCommPar->transmissionType >= 253)
+        return 0;
+
+    /* synchronous RTR PDO, data are sampled at every SYNC and sent on RTR */
+    if(TPDO->TPDOCommPar->transmissionType == 252){
+        DISABLE_INTERRUPTS();
+        CO_TPDO_latch(TPDO, 0);
+        ENABLE_INTERRUPTS();
+        return 0;
+    }
+
+    if(!SYNC->running || !SYNC->curentSyncTimeIsInsideWindow)
+        return 0;
+
+    /* synchronous acyclic PDO */
+    if(TPDO->TPDOCommPar->transmissionType == 0)
+        return TPDO->sendRequest ? 1 : 0;
+
+    /* synchronous cyclic PDO, is the start of transmission */
+    if(TPDO->syncCounter == 255){
+        if(SYNC->counterOverflowValue && TPDO->TPDOCommPar->SYNCStartValue)
+            TPDO->syncCounter = 254;   /* SYNCStartValue is in use */
+        else
+            TPDO->syncCounter = TPDO->TPDOCommPar->transmissionType;
+    }
+
+    /* if the SYNCStartValue is in use, start first TPDO after SYNC with matched SYNCStartValue. */
+    if(TPDO->syncCounter == 254){
+        if(SYNC->counter == TPDO->TPDOCommPar->SYNCStartValue){
+            TPDO->syncCounter = TPDO->TPDOCommPar->transmissionType;
+            return 1;
+        }
+    }
+    /* Send PDO after every N-th Sync */
+    else if(--TPDO->syncCounter == 0){
+        TPDO->syncCounter = TPDO->TPDOCommPar->transmissionType;
+        return 1;
+    }
+
+    return 0;
+}
+
+
+/******************************************************************************/
+uint8_t CO_TPDOisSYNCslot(CO_TPDO_t *TPDO){
+
+    if(!TPDO->SYNCpending)
+        return 0;
+
+    if(!TPDO->valid || *TPDO->operatingState != CO_NMT_OPERATIONAL){
+        TPDO->SYNCpending = 0;
+        TPDO->groupLatched = 0;
+        return 0;
+    }
+
+    /* wait for own time slot. Offset not smaller than SYNC period (it may
+    be changed after the offset) is not used, TPDO is then sent at once. */
+    if(TPDO->SYNCoffset && *TPDO->SYNCoffset){
+        if(TPDO->SYNC->periodTime && *TPDO->SYNCoffset >= TPDO->SYNC->periodTime){
+            CO_errorReport(TPDO->EM, ERROR_TPDO_OUTSIDE_WINDOW, *TPDO->SYNCoffset);
+        }
+        else if(getTime_us(&TPDO->SYNC->timestamp) < *TPDO->SYNCoffset){
+            return 0;
+        }
+    }
+
+    TPDO->SYNCpending = 0;
+    return 1;
+}
+
+
+/******************************************************************************/
+void CO_TPDO_latchGroup(
+        CO_TPDO_t              *TPDO[],
+        uint16_t                noOfTPDO,
+        uint8_t                 group)
+{
+    uint16_t i;
+
+    if(group == 0) return;
+
+    DISABLE_INTERRUPTS();
+    for(i=0; i<noOfTPDO; i++){
+        uint8_t transmissionType = TPDO[i]->TPDOCommPar->transmissionType;
+
+        /* RTR PDOs have own sampling rules */
+        if(transmissionType == 252 || transmissionType == 253) continue;
+
+        if(TPDO[i]->valid && TPDO[i]->group && *TPDO[i]->group == group)
+            CO_TPDO_latch(TPDO[i], 1);
+    }
+    ENABLE_INTERRUPTS();
+}
+
+
+/******************************************************************************/
+void CO_TPDO_latchSYNC(
+        CO_TPDO_t              *TPDO[],
+        uint16_t                noOfTPDO)
+{
+    uint16_t i;
+
+    DISABLE_INTERRUPTS();
+    for(i=0; i<noOfTPDO; i++){
+        if(TPDO[i]->SYNCpending && TPDO[i]->group && *TPDO[i]->group)
+            CO_TPDO_latch(TPDO[i], 1);
+    }
+    ENABLE_INTERRUPTS();
+}
+
+
+/******************************************************************************/
+uint32_t CO_RPDO_prepareMap(
+        CO_RPDO_t              *RPDO,
+        const CO_RPDOMapPar_t  *mapPar)
+{
+    uint32_t ret;
+    uint32_t map;
+    uint8_t dummy;
+
+    RPDO->shadowPending = 0;
+
+    if(mapPar->numberOfMappedObjects > 8)
+        return 0x06090031L;  /* Value of parameter written too high. */
+
+    ret = CO_PDObuildMap(
+            RPDO->SDO,
+            0,
+            &mapPar->mappedObject1,
+            mapPar->numberOfMappedObjects,
+            RPDO->shadowMapPointer,
+            &RPDO->shadowDataLength,
+            &dummy,
+            &map);
+    if(ret) return ret;
+
+    /* PDO must stay valid, use communication parameter to disable it */
+    if(RPDO->shadowDataLength == 0)
+        return 0x06090030L;  /* Invalid value for parameter (download only). */
+
+    RPDO->shadowMapPar = mapPar;
+    RPDO->shadowPending = 1;
+
+    return 0;
+}
+
+
+/******************************************************************************/
+uint32_t CO_TPDO_prepareMap(
+        CO_TPDO_t              *TPDO,
+        const CO_TPDOMapPar_t  *mapPar)
+{
+    uint32_t ret;
+    uint32_t map;
+
+    TPDO->shadowPending = 0;
+
+    if(mapPar->numberOfMappedObjects > 8)
+        return 0x06090031L;  /* Value of parameter written too high. */
+
+    ret = CO_PDObuildMap(
+            TPDO->SDO,
+            1,
+            &mapPar->mappedObject1,
+            mapPar->numberOfMappedObjects,
+            TPDO->shadowMapPointer,
+            &TPDO->shadowDataLength,
+            &TPDO->shadowSendIfCOSFlags,
+            &map);
+    if(ret) return ret;
+
+    /* PDO must stay valid, use communication parameter to disable it */
+    if(TPDO->shadowDataLength == 0)
+        return 0x06090030L;  /* Invalid value for parameter (download only). */
+
+    TPDO->shadowMapPar = mapPar;
+    TPDO->shadowPending = 1;
+
+    return 0;
+}
+
+
+/******************************************************************************/
+void CO_RPDO_swapMap(CO_RPDO_t *RPDO){
+    int16_t i;
+
+    if(!RPDO->shadowPending) return;
+
+    /* receive interrupt uses mapping for length check and for the callback */
+    DISABLE_INTERRUPTS();
+    for(i=0; i<8; i++)
+        RPDO->mapPointer[i] = RPDO->shadowMapPointer[i];
+    RPDO->dataLength = RPDO->shadowDataLength;
+    /* message not processed yet was received with the old layout */
+    RPDO->CANrxNew = 0;
+    ENABLE_INTERRUPTS();
+
+    /* Object dictionary shows the active mapping */
+    *((CO_RPDOMapPar_t*)RPDO->RPDOMapPar) = *RPDO->shadowMapPar;
+    RPDO->shadowPending = 0;
+}
+
+
+/******************************************************************************/
+void CO_TPDO_swapMap(CO_TPDO_t *TPDO){
+    int16_t i;
+
+    if(!TPDO->shadowPending) return;
+
+    DISABLE_INTERRUPTS();
+    for(i=0; i<8; i++)
+        TPDO->mapPointer[i] = TPDO->shadowMapPointer[i];
+    TPDO->dataLength = TPDO->shadowDataLength;
+    TPDO->sendIfCOSFlags = TPDO->shadowSendIfCOSFlags;
+    /* latched data have the old layout */
+    TPDO->groupLatched = 0;
+    TPDO->latched = 0;
+    ENABLE_INTERRUPTS();
+
+    /* Object dictionary shows the active mapping */
+    *((CO_TPDOMapPar_t*)TPDO->TPDOMapPar) = *TPDO->shadowMapPar;
+    TPDO->shadowPending = 0;
+}
+
+
 /******************************************************************************/
 int16_t CO_TPDOsend(CO_TPDO_t *TPDO){
     int16_t i;
+    int16_t ret;
+    uint8_t fromGroup = TPDO->groupLatched;
     uint8_t* pPDOdataByte;
     uint8_t** ppODdataByte;
 
     pPDOdataByte = &TPDO->CANtxBuff->data[0];
-    ppODdataByte = &TPDO->mapPointer[0];
 
-    for(i=TPDO->dataLength; i>0; i--)
-        *(pPDOdataByte++) = **(ppODdataByte++);
+    /* length may change with shadow mapping */
+    TPDO->CANtxBuff->DLC = TPDO->dataLength;
+
+    /* group data are used for one transmission only */
+    if(fromGroup){
+        for(i=0; i<TPDO->dataLength; i++)
+            pPDOdataByte[i] = TPDO->groupData[i];
+    }
+    else{
+        ppODdataByte = &TPDO->mapPointer[0];
+
+        for(i=TPDO->dataLength; i>0; i--)
+            *(pPDOdataByte++) = **(ppODdataByte++);
+    }
 
     TPDO->sendRequest = 0;
 
-    return CO_CANsend(TPDO->CANdevTx, TPDO->CANtxBuff);
+    ret = CO_CANsend(TPDO->CANdevTx, TPDO->CANtxBuff);
+
+    /* on failure group data are kept for the retry */
+    if(fromGroup && ret == CO_ERROR_NO) TPDO->groupLatched = 0;
+
+    return ret;
 }
 
 
 /******************************************************************************/
 void CO_RPDO_process(CO_RPDO_t *RPDO){
 
-    if(RPDO->CANrxNew && RPDO->valid && *RPDO->operatingState == CO_NMT_OPERATIONAL){
-        int16_t i;
-        uint8_t* pPDOdataByte;
-        uint8_t** ppODdataByte;
+    if(RPDO->valid && *RPDO->operatingState == CO_NMT_OPERATIONAL){
+        if(RPDO->CANrxNew){
+            int16_t i;
+            uint16_t seq;
+            uint8_t data[8];
+            uint8_t* pPDOdataByte;
+            uint8_t** ppODdataByte;
+
+            /* copy consistent data, repeat if new message was received meanwhile */
+            do{
+                seq = RPDO->CANrxSeq;
+                RPDO->CANrxNew = 0;
+                for(i=0; i<8; i++) data[i] = RPDO->CANrxData[i];
+            }while((seq & 1) || seq != RPDO->CANrxSeq);
+
+            /* mapped objects were already written in receive interrupt */
+            if(!CO_RPDO_isrMode(RPDO)){
+                pPDOdataByte = &data[0];
+                ppODdataByte = &RPDO->mapPointer[0];
+                for(i=RPDO->dataLength; i>0; i--)
+                    **(ppODdataByte++) = *(pPDOdataByte++);
+
+                if(RPDO->pFunctRx) RPDO->pFunctRx(RPDO->functRxObject, data, RPDO->dataLength);
+            }
 
-        pPDOdataByte = &RPDO->CANrxData[0];
-        ppODdataByte = &RPDO->mapPointer[0];
-        for(i=RPDO->dataLength; i>0; i--)
-            **(ppODdataByte++) = *(pPDOdataByte++);
-    }
+            if(RPDO->rxTimeout){
+                RPDO->rxTimeout = 0;
+                CO_errorReset(RPDO->EM, ERROR_RPDO_TIME_OUT, CO_RPDO_COB_ID(RPDO));
+            }
+        }
 
-    RPDO->CANrxNew = 0;
+        /* verify deadline */
+        else if(RPDO->rxMonitored && !RPDO->rxTimeout && RPDO->RPDOCommPar->eventTimer
+                && getTime_us(&RPDO->rxTimestamp) > (uint32_t)RPDO->RPDOCommPar->eventTimer * 1000){
+            RPDO->rxTimeout = 1;
+            if(RPDO->statistics) RPDO->statistics[5]++;
+            CO_errorReport(RPDO->EM, ERROR_RPDO_TIME_OUT, CO_RPDO_COB_ID(RPDO));
+        }
+    }
+    else{
+        RPDO->rxMonitored = 0;
+        if(RPDO->rxTimeout){
+            RPDO->rxTimeout = 0;
+            CO_errorReset(RPDO->EM, ERROR_RPDO_TIME_OUT, CO_RPDO_COB_ID(RPDO));
+        }
+        RPDO->CANrxNew = 0;
+    }
 }
 
 
 /******************************************************************************/
 void CO_TPDO_process(
         CO_TPDO_t              *TPDO,
-        CO_SYNC_t              *SYNC,
         uint16_t                timeDifference_100us,
         uint16_t                timeDifference_ms)
 {
+#if CO_TPDO_HIGH_RES == 1
+    uint32_t now = getTimeNow_us();
+    uint32_t period = CO_TPDO_eventPeriod_us(TPDO);
+
+    /* timers are free running, see CO_TPDO_initHighRes() */
+    (void)timeDifference_100us;
+    (void)timeDifference_ms;
+#else
     int32_t i;
+#endif
     
     
     if(TPDO->valid && *TPDO->operatingState == CO_NMT_OPERATIONAL){
         /* Send PDO by application request or by Event timer */
-        if(TPDO->TPDOCommPar->transmissionType >= 253){
+        if(TPDO->TPDOCommPar->transmissionType >= 254){
+#if CO_TPDO_HIGH_RES == 1
+            uint8_t eventExpired = (period && (int32_t)(now - TPDO->eventDeadline) >= 0) ? 1 : 0;
+
+            if((int32_t)(now - TPDO->inhibitDeadline) >= 0 && (TPDO->sendRequest || eventExpired)){
+                if(CO_TPDOsend(TPDO) == CO_ERROR_NO){
+                    /* successfully sent */
+                    TPDO->inhibitDeadline = now + (uint32_t)TPDO->TPDOCommPar->inhibitTime * 100;
+                    /* next event is scheduled from the previous deadline, so period does not drift */
+                    if(eventExpired) TPDO->eventDeadline += period;
+                    if(!eventExpired || (int32_t)(now - TPDO->eventDeadline) >= 0)
+                        TPDO->eventDeadline = now + period;
+                }
+            }
+#else
             
             if(TPDO->inhibitTimer == 0 && (TPDO->sendRequest || (TPDO->TPDOCommPar->eventTimer && TPDO->eventTimer == 0))){
                 if(CO_TPDOsend(TPDO) == CO_ERROR_NO){
@@ -873,53 +1898,38 @@ void CO_TPDO_process(
                     TPDO->eventTimer = TPDO->TPDOCommPar->eventTimer;
                 }
             }
+#endif
         }
-        /* Synchronous PDOs */
-        else if(SYNC && SYNC->running && SYNC->curentSyncTimeIsInsideWindow){
-            /* detect SYNC message */
-            if(SYNC->timer < TPDO->SYNCtimerPrevious){
-
-                /* send synchronous acyclic PDO */
-                if(TPDO->TPDOCommPar->transmissionType == 0){
-                    if(TPDO->sendRequest){
-                      CO_TPDOsend(TPDO);
-                    }
-                }
-                /* send synchronous cyclic PDO */
-                else{
-                    
-                    /* is the start of synchronous TPDO transmission */
-                    if(TPDO->syncCounter == 255){
-                        if(SYNC->counterOverflowValue && TPDO->TPDOCommPar->SYNCStartValue)
-                            TPDO->syncCounter = 254;   /* SYNCStartValue is in use */
-                        else
-                            TPDO->syncCounter = TPDO->TPDOCommPar->transmissionType;
-                    }
-                    /* if the SYNCStartValue is in use, start first TPDO after SYNC with matched SYNCStartValue. */
-                    if(TPDO->syncCounter == 254){
-                        if(SYNC->counter == TPDO->TPDOCommPar->SYNCStartValue){
-                            TPDO->syncCounter = TPDO->TPDOCommPar->transmissionType;
-                            CO_TPDOsend(TPDO);
-                        }
-                    }
-                    /* Send PDO after every N-th Sync */
-                    else if(--TPDO->syncCounter == 0){
-                        TPDO->syncCounter = TPDO->TPDOCommPar->transmissionType;
-                        CO_TPDOsend(TPDO);
-                    }
-                }
-            }
-            
-            TPDO->SYNCtimerPrevious = SYNC->timer;
-        }
-
+        /* Synchronous PDOs are sent after CO_TPDOisSYNC() */
     }
     else{
         /* Not operational or valid. Force TPDO first send after operational or valid. */
         if(TPDO->TPDOCommPar->transmissionType>=254) TPDO->sendRequest = 1;
         else                                         TPDO->sendRequest = 0;
+
+#if CO_TPDO_HIGH_RES == 1
+        TPDO->inhibitDeadline = now;
+        TPDO->eventDeadline = now;
+#endif
+
+#if CO_TPDO_PHASE_SPREAD == 1
+        /* With event timer, first send is in own phase, not together with other TPDOs. */
+  #if CO_TPDO_HIGH_RES == 1
+        if(TPDO->TPDOCommPar->transmissionType>=254 && period){
+            TPDO->sendRequest = 0;
+            TPDO->eventDeadline = now + (period >> 16) * TPDO->eventPhase
+                                + (((period & 0xFFFF) * TPDO->eventPhase) >> 16);
+        }
+  #else
+        if(TPDO->TPDOCommPar->transmissionType>=254 && TPDO->TPDOCommPar->eventTimer){
+            TPDO->sendRequest = 0;
+            TPDO->eventTimer = (uint16_t)(((uint32_t)TPDO->TPDOCommPar->eventTimer * TPDO->eventPhase) >> 16);
+        }
+  #endif
+#endif
     }
 
+#if CO_TPDO_HIGH_RES != 1
     /* update timers */
     i = TPDO->inhibitTimer;
     i -= timeDifference_100us;
@@ -928,4 +1938,5 @@ void CO_TPDO_process(
     i = TPDO->eventTimer;
     i -= timeDifference_ms;
     TPDO->eventTimer = (i<=0) ? 0 : (uint16_t)i;
+#endif
 }
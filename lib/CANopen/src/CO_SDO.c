@@ -61,6 +61,75 @@
     #error CO_SDO_BUFFER_SIZE must be greater than 7
 #endif
 
+
+#if CO_SDO_FAST_UPLOAD == 1
+/*
+ * Answer expedited SDO upload request directly from CAN receive interrupt.
+ *
+ * Only plain readable variables from 1 to 4 bytes long without OD function are
+ * served. SDO server must be idle and its transmit buffer free.
+ *
+ * @return 1 if response was sent, 0 if request must be processed by CO_SDO_process().
+ */
+static uint8_t CO_SDO_fastUpload(CO_SDO_t *SDO, const uint8_t *data){
+    uint16_t index;
+    uint16_t entryNo;
+    uint8_t subIndex;
+    uint16_t attribute;
+    uint16_t length;
+    uint8_t *ODdata;
+    uint8_t i;
+
+    if(!SDO->fastUploadEnabled || SDO->state != STATE_IDLE || SDO->CANtxBuff->bufferFull)
+        return 0;
+
+    index = (uint16_t)data[2]<<8 | data[1];
+    subIndex = data[3];
+
+    /* find object in Object Dictionary, use the last result if same index */
+    if(index == SDO->fastIndex && SDO->fastEntryNo != 0xFFFF){
+        entryNo = SDO->fastEntryNo;
+    }
+    else{
+        entryNo = CO_OD_find(SDO, index);
+        if(entryNo == 0xFFFF) return 0;
+        SDO->fastIndex = index;
+        SDO->fastEntryNo = entryNo;
+    }
+
+    if(subIndex > SDO->OD[entryNo].maxSubIndex) return 0;
+    if(SDO->ODExtensions && SDO->ODExtensions[entryNo].pODFunc) return 0;
+
+    attribute = CO_OD_getAttribute(SDO, entryNo, subIndex);
+    if(!(attribute & CO_ODA_READABLE)) return 0;
+
+    ODdata = (uint8_t*)CO_OD_getDataPointer(SDO, entryNo, subIndex);
+    length = CO_OD_getLength(SDO, entryNo, subIndex);
+    if(ODdata == 0 || length == 0 || length > 4) return 0;
+
+    /* prepare response */
+    SDO->CANtxBuff->data[0] = 0x43 | ((4-length) << 2);
+    SDO->CANtxBuff->data[1] = data[1];
+    SDO->CANtxBuff->data[2] = data[2];
+    SDO->CANtxBuff->data[3] = data[3];
+    SDO->CANtxBuff->data[4] = SDO->CANtxBuff->data[5] = SDO->CANtxBuff->data[6] = SDO->CANtxBuff->data[7] = 0;
+#ifdef BIG_ENDIAN
+    if(attribute & CO_ODA_MB_VALUE){
+        for(i=0; i<length; i++)
+            SDO->CANtxBuff->data[4+i] = ODdata[length-1-i];
+    }
+    else
+#endif
+    for(i=0; i<length; i++)
+        SDO->CANtxBuff->data[4+i] = ODdata[i];
+
+    CO_CANsend(SDO->CANdevTx, SDO->CANtxBuff);
+
+    return 1;
+}
+#endif
+
+
 /*
  * Read received message from CAN module.
  *
@@ -79,7 +148,18 @@ static int16_t CO_SDO_receive(void *object, CO_CANrxMsg_t *msg){
     if(msg->DLC != 8) return CO_ERROR_RX_MSG_LENGTH;
 
     /* verify message overflow (previous message was not processed yet) */
-    if(SDO->CANrxNew) return CO_ERROR_RX_OVERFLOW;
+    if(SDO->CANrxNew){
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+        SDO->rxOverflowCnt++;
+#endif
+        return CO_ERROR_RX_OVERFLOW;
+    }
+
+#if CO_SDO_FAST_UPLOAD == 1
+    /* expedited upload of plain variable may be answered immediately */
+    if((msg->data[0] >> 5) == CCS_UPLOAD_INITIATE && CO_SDO_fastUpload(SDO, msg->data))
+        return CO_ERROR_NO;
+#endif
 
     /* copy data and set 'new message' flag */
     SDO->CANrxData[0] = msg->data[0];
@@ -162,6 +242,16 @@ int16_t CO_SDO_init(
     SDO->nodeId = nodeId;
     SDO->state = STATE_IDLE;
     SDO->CANrxNew = 0;
+#if CO_SDO_FAST_UPLOAD == 1
+    SDO->fastUploadEnabled = 0;
+    SDO->fastIndex = 0;
+    SDO->fastEntryNo = 0xFFFF;
+#endif
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+    SDO->blksizeAdaptive = (CO_SDO_BUFFER_SIZE > (7*127)) ? 127 : (CO_SDO_BUFFER_SIZE / 7);
+    SDO->rxOverflowCnt = 0;
+    SDO->rxOverflowBlock = 0;
+#endif
 
     /* Configure Object dictionary entry at index 0x1200 */
     if(ObjDictIndex_SDOServerParameter == 0x1200)
@@ -508,6 +598,48 @@ uint32_t CO_SDO_writeOD(CO_SDO_t *SDO, uint16_t length){
 }
 
 
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+/******************************************************************************/
+uint8_t CO_SDO_blksizeAdapt(uint8_t blksize, uint8_t blksizeMax, uint8_t lost){
+    if(lost)
+        blksize /= 2;
+    else if(blksize < blksizeMax)
+        blksize++;
+
+    if(blksize > blksizeMax) blksize = blksizeMax;
+    if(blksize < 1) blksize = 1;
+
+    return blksize;
+}
+
+
+/******************************************************************************/
+void CO_SDO_blockStatsEnd(CO_SDO_blockStats_t *stats){
+    if(stats->time_ms == 0)
+        stats->bytesPerSecond = 0;   /* transfer too short to be measured */
+    else if(stats->bytes < (0xFFFFFFFFL / 1000))
+        stats->bytesPerSecond = stats->bytes * 1000 / stats->time_ms;
+    else
+        stats->bytesPerSecond = stats->bytes / stats->time_ms * 1000;
+}
+
+
+/*
+ * Clear statistics at the start of the block transfer.
+ */
+static void CO_SDO_blockStatsStart(CO_SDO_t *SDO){
+    SDO->blockStats.bytes = 0;
+    SDO->blockStats.time_ms = 0;
+    SDO->blockStats.bytesPerSecond = 0;
+    SDO->blockStats.segments = 0;
+    SDO->blockStats.retransmitted = 0;
+    SDO->blockStats.rxOverflow = 0;
+    SDO->blockStats.blksize = SDO->blksize;
+    SDO->rxOverflowBlock = SDO->rxOverflowCnt;
+}
+#endif
+
+
 /******************************************************************************/
 static void CO_SDO_abort(CO_SDO_t *SDO, uint32_t code){
     SDO->CANtxBuff->data[0] = 0x80;
@@ -515,9 +647,12 @@ static void CO_SDO_abort(CO_SDO_t *SDO, uint32_t code){
     SDO->CANtxBuff->data[2] = (SDO->ODF_arg.index>>8) & 0xFF;
     SDO->CANtxBuff->data[3] = SDO->ODF_arg.subIndex;
     memcpySwap4(&SDO->CANtxBuff->data[4], (uint8_t*)&code);
+    CO_CANsend(SDO->CANdevTx, SDO->CANtxBuff);
+
+    /* release server after abort is sent, so fast upload from receive
+    interrupt can't take transmit buffer before */
     SDO->state = STATE_IDLE;
     SDO->CANrxNew = 0;
-    CO_CANsend(SDO->CANdevTx, SDO->CANtxBuff);
 }
 
 
@@ -531,6 +666,10 @@ int8_t CO_SDO_process(
     uint8_t state = STATE_IDLE;
     uint8_t timeoutSubblockDownolad = 0;
 
+#if CO_SDO_FAST_UPLOAD == 1
+    SDO->fastUploadEnabled = NMTisPreOrOperational;
+#endif
+
     /* return if idle */
     if(SDO->state == STATE_IDLE && SDO->CANrxNew == 0){
         return 0;
@@ -543,6 +682,12 @@ int8_t CO_SDO_process(
         return 0;
     }
 
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+    /* measure duration of block transfer (block states are 0x14.. and 0x24..) */
+    if((SDO->state & 0x0F) >= 0x04)
+        SDO->blockStats.time_ms += timeDifference_ms;
+#endif
+
     /* Is something new to process? */
     if(!SDO->CANtxBuff->bufferFull && (SDO->CANrxNew || SDO->state == STATE_UPLOAD_BLOCK_SUBBLOCK)){
         uint8_t CCS = SDO->CANrxData[0] >> 5;   /* Client command specifier */
@@ -766,6 +911,11 @@ int8_t CO_SDO_process(
 
             /* blksize */
             SDO->blksize = (CO_SDO_BUFFER_SIZE > (7*127)) ? 127 : (CO_SDO_BUFFER_SIZE / 7);
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+            if(SDO->blksize > SDO->blksizeAdaptive)
+                SDO->blksize = SDO->blksizeAdaptive;
+            CO_SDO_blockStatsStart(SDO);
+#endif
             SDO->CANtxBuff->data[4] = SDO->blksize;
 
             /* is CRC enabled */
@@ -804,11 +954,17 @@ int8_t CO_SDO_process(
             else{
                 /* if waiting for first segment and received wrong segment just ignore it */
                 if(SDO->sequence == 0 && (SDO->CANrxData[0] & 0x7f) != 1){
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                    SDO->blockStats.retransmitted++;
+#endif
                     break;
                 }
 
                 /* previous segment is received again, ignore it */
                 else if((SDO->CANrxData[0] & 0x7f) == SDO->sequence){
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                    SDO->blockStats.retransmitted++;
+#endif
                     break;
                 }
 
@@ -818,6 +974,10 @@ int8_t CO_SDO_process(
                     err = 0;
                     for(i=0; i<7; i++)
                         SDO->ODF_arg.data[SDO->bufferOffset++] = SDO->CANrxData[i+1];
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                    SDO->blockStats.segments++;
+                    SDO->blockStats.bytes += 7;
+#endif
                 }
             }
 
@@ -846,9 +1006,24 @@ int8_t CO_SDO_process(
                     SDO->bufferOffset = 0;
                 }
 
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                /* adapt block size to lost segments and receive overflows */
+                if(err && !timeoutSubblockDownolad)
+                    SDO->blockStats.retransmitted++;
+                SDO->blksizeAdaptive = CO_SDO_blksizeAdapt(SDO->blksizeAdaptive, 127,
+                        err || SDO->rxOverflowCnt != SDO->rxOverflowBlock);
+                SDO->blockStats.rxOverflow += SDO->rxOverflowCnt - SDO->rxOverflowBlock;
+                SDO->rxOverflowBlock = SDO->rxOverflowCnt;
+#endif
+
                 /* blksize */
                 len = CO_SDO_BUFFER_SIZE - SDO->bufferOffset;
                 SDO->blksize = (len > (7*127)) ? 127 : (len / 7);
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                if(SDO->blksize > SDO->blksizeAdaptive)
+                    SDO->blksize = SDO->blksizeAdaptive;
+                SDO->blockStats.blksize = SDO->blksize;
+#endif
                 SDO->CANtxBuff->data[2] = SDO->blksize;
 
                 /* last segment */
@@ -898,6 +1073,11 @@ int8_t CO_SDO_process(
                 return -1;
             }
 
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+            SDO->blockStats.bytes -= len;
+            CO_SDO_blockStatsEnd(&SDO->blockStats);
+#endif
+
             /* send response */
             SDO->CANtxBuff->data[0] = 0xA1;
             CO_CANsend(SDO->CANdevTx, SDO->CANtxBuff);
@@ -1068,6 +1248,9 @@ int8_t CO_SDO_process(
             SDO->endOfTransfer = 0;
             SDO->CANrxNew = 0;
             SDO->state = STATE_UPLOAD_BLOCK_SUBBLOCK;
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+            CO_SDO_blockStatsStart(SDO);
+#endif
             /* continue in next case */
         }
 
@@ -1091,8 +1274,19 @@ int8_t CO_SDO_process(
                     return -1;
                 }
 
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                /* segments after ackseq will be sent again */
+                SDO->blockStats.retransmitted += SDO->sequence - ackseq;
+#endif
+
                 /* end of transfer */
                 if(SDO->endOfTransfer && ackseq == SDO->blksize){
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                    SDO->blockStats.bytes += (ackseq - 1) * 7 + SDO->lastLen;
+                    SDO->blockStats.rxOverflow = SDO->rxOverflowCnt - SDO->rxOverflowBlock;
+                    CO_SDO_blockStatsEnd(&SDO->blockStats);
+#endif
+
                     /* first response byte */
                     SDO->CANtxBuff->data[0] = 0xC1 | ((7 - SDO->lastLen) << 2);
 
@@ -1114,8 +1308,15 @@ int8_t CO_SDO_process(
                 /* set remaining data length in buffer */
                 SDO->ODF_arg.dataLength -= ackseq * 7;
 
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                SDO->blockStats.bytes += ackseq * 7;
+#endif
+
                 /* new block size */
                 SDO->blksize = SDO->CANrxData[2];
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                SDO->blockStats.blksize = SDO->blksize;
+#endif
 
                 /* If data type is domain, re-fill the data buffer if neccessary and indicated so. */
                 if(SDO->ODF_arg.ODdataStorage == 0 && SDO->ODF_arg.dataLength < (SDO->blksize*7) && SDO->ODF_arg.lastSegment == 0){
@@ -1171,6 +1372,9 @@ int8_t CO_SDO_process(
 
             /* first response byte */
             SDO->CANtxBuff->data[0] = ++SDO->sequence;
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+            SDO->blockStats.segments++;
+#endif
 
             /* verify end of transfer */
             if(SDO->bufferOffset==SDO->ODF_arg.dataLength && SDO->ODF_arg.lastSegment){
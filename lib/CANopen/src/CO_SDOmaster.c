@@ -123,7 +123,12 @@ static int16_t CO_SDOclient_receive(void *object, CO_CANrxMsg_t *msg){
     if(msg->DLC != 8) return CO_ERROR_RX_MSG_LENGTH;
 
     /* verify message overflow (previous message was not processed yet) */
-    if(SDO_C->CANrxNew) return CO_ERROR_RX_OVERFLOW;
+    if(SDO_C->CANrxNew){
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+        SDO_C->rxOverflowCnt++;
+#endif
+        return CO_ERROR_RX_OVERFLOW;
+    }
 
     /* copy data and set 'new message' flag */
     SDO_C->CANrxData[0] = msg->data[0];
@@ -162,8 +167,13 @@ int16_t CO_SDOclient_init(
     /* Configure object variables */
     SDO_C->state = 0;
 
-    SDO_C->pst    = 21; /*  block transfer */
-    SDO_C->block_size_max = 127; /*  block transfer */
+    SDO_C->pst    = CO_SDO_CLIENT_PST; /*  block transfer */
+    SDO_C->block_size_max = CO_SDO_CLIENT_BLOCK_SIZE_MAX; /*  block transfer */
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+    SDO_C->blksizeAdaptive = SDO_C->block_size_max;
+    SDO_C->rxOverflowCnt = 0;
+    SDO_C->rxOverflowBlock = 0;
+#endif
 
     SDO_C->SDO = SDO;
     SDO_C->SDOClientPar = SDOClientPar;
@@ -171,6 +181,9 @@ int16_t CO_SDOclient_init(
     SDO_C->pFunctSignal = 0;
     SDO_C->functArg = 0;
 
+    SDO_C->pFunctStream = 0;
+    SDO_C->streamObject = 0;
+
     SDO_C->CANdevRx = CANdevRx;
     SDO_C->CANdevRxIdx = CANdevRxIdx;
     SDO_C->CANdevTx = CANdevTx;
@@ -267,6 +280,43 @@ static uint8_t CO_SDObufferClear(uint8_t *p, uint32_t length){
 }
 
 
+/*
+ * Pass data received in buffer to the stream consumer and empty the buffer.
+ *
+ * Used by streaming upload, see CO_SDOclientUploadInitiateStream().
+ *
+ * @return 0 or SDO abort code returned by the consumer.
+ */
+static uint32_t CO_SDOclient_streamFlush(CO_SDOclient_t *SDO_C, uint32_t length){
+    uint32_t abortCode = 0;
+
+    if(length){
+        SDO_C->streamCrc = crc16_ccitt((unsigned char *)SDO_C->buffer, (unsigned int)length, SDO_C->streamCrc);
+        abortCode = SDO_C->pFunctStream(SDO_C->streamObject, SDO_C->buffer, length);
+    }
+    SDO_C->bufferOffset = 0;
+
+    return abortCode;
+}
+
+
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+/*
+ * Clear statistics at the start of the block transfer.
+ */
+static void CO_SDOclient_blockStatsStart(CO_SDOclient_t *SDO_C){
+    SDO_C->blockStats.bytes = 0;
+    SDO_C->blockStats.time_ms = 0;
+    SDO_C->blockStats.bytesPerSecond = 0;
+    SDO_C->blockStats.segments = 0;
+    SDO_C->blockStats.retransmitted = 0;
+    SDO_C->blockStats.rxOverflow = 0;
+    SDO_C->blockStats.blksize = SDO_C->block_blksize;
+    SDO_C->rxOverflowBlock = SDO_C->rxOverflowCnt;
+}
+#endif
+
+
 /*******************************************************************************
  *
  * DOWNLOAD
@@ -468,6 +518,9 @@ int8_t CO_SDOclientDownload(
                     }
                     /*  set blksize */
                     SDO_C->block_blksize = SDO_C->CANrxData[4];
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                    CO_SDOclient_blockStatsStart(SDO_C);
+#endif
 
                     SDO_C->block_seqno = 0;
                     SDO_C->bufferOffset = 0;
@@ -494,8 +547,12 @@ int8_t CO_SDOclientDownload(
                     }
                     /*  check number of segments */
                     if(SDO_C->CANrxData[1] != SDO_C->block_blksize){
-                        /*  NOT all segments transfert sucesfuly */
-                        SDO_C->bufferOffsetACK = SDO_C->CANrxData[1] * 7;
+                        /*  NOT all segments transfert sucesfuly, continue after
+                            the last acknowledged segment of this block */
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                        SDO_C->blockStats.retransmitted += SDO_C->block_blksize - SDO_C->CANrxData[1];
+#endif
+                        SDO_C->bufferOffsetACK += SDO_C->CANrxData[1] * 7;
                         SDO_C->bufferOffset = SDO_C->bufferOffsetACK;
                     }
                     else{
@@ -504,6 +561,9 @@ int8_t CO_SDOclientDownload(
                     /*  set size of next block */
                     SDO_C->block_blksize = SDO_C->CANrxData[2];
                     SDO_C->block_seqno = 0;
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                    SDO_C->blockStats.blksize = SDO_C->block_blksize;
+#endif
 
                     if(SDO_C->bufferOffset >= SDO_C->bufferSize)
                         SDO_C->state = SDO_STATE_BLOCKDOWNLOAD_CRC;
@@ -526,6 +586,11 @@ int8_t CO_SDOclientDownload(
                         break;
                     }
                     /*  SDO bloct download sucesfuly transferd */
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                    SDO_C->blockStats.bytes = SDO_C->bufferSize;
+                    SDO_C->blockStats.rxOverflow = SDO_C->rxOverflowCnt - SDO_C->rxOverflowBlock;
+                    CO_SDO_blockStatsEnd(&SDO_C->blockStats);
+#endif
                     SDO_C->state = SDO_STATE_NOTDEFINED;
                     SDO_C->timeoutTimer = 0;
                     SDO_C->CANrxNew = 0;
@@ -551,6 +616,10 @@ int8_t CO_SDOclientDownload(
     if(SDO_C->timeoutTimer < SDOtimeoutTime){
         SDO_C->timeoutTimer += timeDifference_ms;
     }
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+    if(SDO_C->state >= SDO_STATE_BLOCKDOWNLOAD_INITIATE && SDO_C->state <= SDO_STATE_BLOCKDOWNLOAD_CRC_ACK)
+        SDO_C->blockStats.time_ms += timeDifference_ms;
+#endif
     if(SDO_C->timeoutTimer >= SDOtimeoutTime){ /*  comunication TMO */
         *pSDOabortCode = 0x05040000L;    /* SDO protocol timed out */
         CO_SDOclient_abort(SDO_C, *pSDOabortCode);
@@ -600,6 +669,9 @@ int8_t CO_SDOclientDownload(
             if(SDO_C->block_seqno >= SDO_C->block_blksize){
                 SDO_C->state = SDO_STATE_BLOCKDOWNLOAD_BLOCK_ACK;
             }
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+            SDO_C->blockStats.segments++;
+#endif
             /*  set data */
             SDO_C->block_noData = 0;
 
@@ -661,13 +733,19 @@ int8_t CO_SDOclientDownload(
  * UPLOAD
  *
  ******************************************************************************/
-int8_t CO_SDOclientUploadInitiate(
+/*
+ * Initiate SDO upload, common for CO_SDOclientUploadInitiate() and
+ * CO_SDOclientUploadInitiateStream().
+ */
+static int8_t CO_SDOclientUploadStart(
         CO_SDOclient_t         *SDO_C,
         uint16_t                index,
         uint8_t                 subIndex,
         uint8_t                *dataRx,
         uint32_t                dataRxSize,
-        uint8_t                 blockEnable)
+        uint8_t                 blockEnable,
+        uint32_t              (*pFunctStream)(void *object, const uint8_t *data, uint32_t length),
+        void                   *streamObject)
 {
     /* verify parameters */
     if(dataRx == 0 || dataRxSize < 4) return -2;
@@ -675,6 +753,11 @@ int8_t CO_SDOclientUploadInitiate(
     /* save parameters */
     SDO_C->buffer = dataRx;
     SDO_C->bufferSize = dataRxSize;
+    SDO_C->bufferOffset = 0;
+    SDO_C->dataSizeTransfered = 0;
+    SDO_C->pFunctStream = pFunctStream;
+    SDO_C->streamObject = streamObject;
+    SDO_C->streamCrc = 0;
     SDO_C->state = 0x40;
 
     /* prepare CAN tx message */
@@ -703,7 +786,15 @@ int8_t CO_SDOclientUploadInitiate(
 
         /*  set number of segments in block */
         SDO_C->block_blksize = SDO_C->block_size_max;
-        if ((SDO_C->block_blksize *7) > SDO_C->bufferSize){
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+        /*  start with the block size learned from previous transfer */
+        if(SDO_C->blksizeAdaptive > 0 && SDO_C->blksizeAdaptive < SDO_C->block_size_max)
+            SDO_C->block_blksize = SDO_C->blksizeAdaptive;
+#endif
+        /*  by streaming only one block must fit into buffer */
+        if(SDO_C->pFunctStream && (SDO_C->block_blksize * 7) >= SDO_C->bufferSize)
+            SDO_C->block_blksize = (SDO_C->bufferSize - 1) / 7;
+        if (SDO_C->block_blksize == 0 || (SDO_C->block_blksize *7) > SDO_C->bufferSize){
             return -3;
         }
 
@@ -729,6 +820,36 @@ int8_t CO_SDOclientUploadInitiate(
 }
 
 
+/******************************************************************************/
+int8_t CO_SDOclientUploadInitiate(
+        CO_SDOclient_t         *SDO_C,
+        uint16_t                index,
+        uint8_t                 subIndex,
+        uint8_t                *dataRx,
+        uint32_t                dataRxSize,
+        uint8_t                 blockEnable)
+{
+    return CO_SDOclientUploadStart(SDO_C, index, subIndex, dataRx, dataRxSize, blockEnable, 0, 0);
+}
+
+
+/******************************************************************************/
+int8_t CO_SDOclientUploadInitiateStream(
+        CO_SDOclient_t         *SDO_C,
+        uint16_t                index,
+        uint8_t                 subIndex,
+        uint8_t                *buffer,
+        uint32_t                bufferSize,
+        uint32_t              (*pFunctStream)(void *object, const uint8_t *data, uint32_t length),
+        void                   *object)
+{
+    /* verify parameters */
+    if(pFunctStream == 0 || bufferSize < 8) return -2;
+
+    return CO_SDOclientUploadStart(SDO_C, index, subIndex, buffer, bufferSize, 1, pFunctStream, object);
+}
+
+
 /******************************************************************************/
 int8_t CO_SDOclientUpload(
         CO_SDOclient_t         *SDO_C,
@@ -777,6 +898,14 @@ int8_t CO_SDOclientUpload(
             return -10;
         }
 
+        /* pass data to the stream consumer */
+        if(SDO_C->pFunctStream){
+            *pSDOabortCode = CO_SDOclient_streamFlush(SDO_C, *pDataSize);
+            if(*pSDOabortCode){
+                return -10;
+            }
+        }
+
         SDO_C->state = 0;
         SDO_C->CANrxNew = 0;
         return 0;
@@ -812,6 +941,15 @@ int8_t CO_SDOclientUpload(
 
                         /* copy data */
                         while(size--) SDO_C->buffer[size] = SDO_C->CANrxData[4+size];
+
+                        /* pass data to the stream consumer */
+                        if(SDO_C->pFunctStream){
+                            *pSDOabortCode = CO_SDOclient_streamFlush(SDO_C, *pDataSize);
+                            if(*pSDOabortCode){
+                                SDO_C->state = SDO_STATE_ABORT;
+                                break;
+                            }
+                        }
                         SDO_C->state = 0;
                         SDO_C->CANrxNew = 0;
 
@@ -820,6 +958,7 @@ int8_t CO_SDOclientUpload(
                     else{
                         /* segmented transfer - prepare first segment */
                         SDO_C->bufferOffset = 0;
+                        SDO_C->dataSizeTransfered = 0;
                         SDO_C->state = SDO_STATE_UPLOAD_REQUEST;
 
                         SDO_C->toggle =0;
@@ -844,6 +983,14 @@ int8_t CO_SDOclientUpload(
                     }
                     /* get size */
                     size = 7 - ((SDO_C->CANrxData[0]>>1)&0x07);
+                    /* pass full buffer to the stream consumer */
+                    if(SDO_C->pFunctStream && (SDO_C->bufferOffset + size) > SDO_C->bufferSize){
+                        *pSDOabortCode = CO_SDOclient_streamFlush(SDO_C, SDO_C->bufferOffset);
+                        if(*pSDOabortCode){
+                            SDO_C->state = SDO_STATE_ABORT;
+                            break;
+                        }
+                    }
                     /* verify length */
                     if((SDO_C->bufferOffset + size) > SDO_C->bufferSize){
                         *pSDOabortCode = 0x05040005L;    /* Out of memory */
@@ -854,9 +1001,17 @@ int8_t CO_SDOclientUpload(
                     for(i=0; i<size; i++)
                     SDO_C->buffer[SDO_C->bufferOffset + i] = SDO_C->CANrxData[1 + i];
                     SDO_C->bufferOffset += size;
+                    SDO_C->dataSizeTransfered += size;
                     /* If no more segments to be uploaded, finish communication */
                     if(SDO_C->CANrxData[0] & 0x01){
-                        *pDataSize = SDO_C->bufferOffset;
+                        if(SDO_C->pFunctStream){
+                            *pSDOabortCode = CO_SDOclient_streamFlush(SDO_C, SDO_C->bufferOffset);
+                            if(*pSDOabortCode){
+                                SDO_C->state = SDO_STATE_ABORT;
+                                break;
+                            }
+                        }
+                        *pDataSize = SDO_C->dataSizeTransfered;
                         SDO_C->state = SDO_STATE_NOTDEFINED;
                         SDO_C->CANrxNew = 0;
                         return SDO_RETURN_COMMUNICATION_END;
@@ -903,13 +1058,17 @@ int8_t CO_SDOclientUpload(
                         SDO_C->dataSize = 0;
                     }
 
-                    /*  check available buffer size */
-                    if (SDO_C->dataSize > SDO_C->bufferSize){
+                    /*  check available buffer size, not needed by streaming */
+                    if (SDO_C->dataSize > SDO_C->bufferSize && SDO_C->pFunctStream == 0){
                         *pSDOabortCode = 0x05040005;
                         SDO_C->state = SDO_STATE_ABORT;
                     }
 
                     SDO_C->dataSizeTransfered =0;
+                    SDO_C->bufferOffset = 0;
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                    CO_SDOclient_blockStatsStart(SDO_C);
+#endif
                 }
                 else if (SCS == SCS_UPLOAD_INITIATE){ /*  switch to regular segmented transfer */
                     if(SDO_C->CANrxData[0] & 0x02){
@@ -924,6 +1083,15 @@ int8_t CO_SDOclientUpload(
 
                         /* copy data */
                         while(size--) SDO_C->buffer[size] = SDO_C->CANrxData[4+size];
+
+                        /* pass data to the stream consumer */
+                        if(SDO_C->pFunctStream){
+                            *pSDOabortCode = CO_SDOclient_streamFlush(SDO_C, *pDataSize);
+                            if(*pSDOabortCode){
+                                SDO_C->state = SDO_STATE_ABORT;
+                                break;
+                            }
+                        }
                         SDO_C->state = 0;
                         SDO_C->CANrxNew = 0;
 
@@ -932,6 +1100,7 @@ int8_t CO_SDOclientUpload(
                     else{
                         /* segmented transfer - prepare first segment */
                         SDO_C->bufferOffset = 0;
+                        SDO_C->dataSizeTransfered = 0;
                         SDO_C->state = SDO_STATE_UPLOAD_REQUEST;
 
                         SDO_C->toggle =0;
@@ -949,7 +1118,9 @@ int8_t CO_SDOclientUpload(
                 /*  check correct seqno */
                 SDO_C->timeoutTimerBLOCK = 0;
                 if((SDO_C->CANrxData[0] & 0x7f) != (SDO_C->block_seqno +1)){
-
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                    SDO_C->blockStats.retransmitted++;
+#endif
 
                     /*  wait block tmo to send block ack */
                     if (SDO_C->block_seqno ==0){
@@ -964,15 +1135,19 @@ int8_t CO_SDOclientUpload(
                 else{
                     uint8_t i;
                     for (i=1; i<8; i++){
-                        *(SDO_C->buffer + SDO_C->dataSizeTransfered) = SDO_C->CANrxData[i];
+                        *(SDO_C->buffer + SDO_C->bufferOffset) = SDO_C->CANrxData[i];
+                        SDO_C->bufferOffset +=1;
                         SDO_C->dataSizeTransfered +=1;
-                        if (SDO_C->dataSizeTransfered >= SDO_C->bufferSize){
+                        if (SDO_C->bufferOffset >= SDO_C->bufferSize){
                             *pSDOabortCode = 0x05040005;
                             SDO_C->state = SDO_STATE_ABORT;
                             break;
                         }
                     }
                     SDO_C->block_seqno += 1;
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                    SDO_C->blockStats.segments++;
+#endif
 
                     if (*pSDOabortCode ==0){
                         if (SDO_C->CANrxData[0]&0x80){
@@ -1003,13 +1178,30 @@ int8_t CO_SDOclientUpload(
                 if (SCS == SCS_UPLOAD_BLOCK){
                     tmp32 = ((SDO_C->CANrxData[0]>>2) & 0x07);
                     SDO_C->dataSizeTransfered -= tmp32;
+                    SDO_C->bufferOffset -= tmp32;
+
+                    /*  pass the rest of data to the stream consumer */
+                    if(SDO_C->pFunctStream){
+                        *pSDOabortCode = CO_SDOclient_streamFlush(SDO_C, SDO_C->bufferOffset);
+                        if(*pSDOabortCode){
+                            SDO_C->state = SDO_STATE_ABORT;
+                            break;
+                        }
+                    }
 
                     SDO_C->state = SDO_STATE_BLOCKUPLOAD_BLOCK_END;
                     if (SDO_C->crcEnabled){
                         uint16_t tmp16;
                         memcpySwap2((uint8_t*)&tmp16, &SDO_C->CANrxData[1]);
 
-                        if (tmp16 != crc16_ccitt((unsigned char *)SDO_C->buffer, (unsigned int)SDO_C->dataSizeTransfered, 0)){
+                        /*  by streaming CRC is calculated incrementally */
+                        if(SDO_C->pFunctStream){
+                            if(tmp16 != SDO_C->streamCrc){
+                                *pSDOabortCode = 0x05040004L;
+                                SDO_C->state = SDO_STATE_ABORT;
+                            }
+                        }
+                        else if (tmp16 != crc16_ccitt((unsigned char *)SDO_C->buffer, (unsigned int)SDO_C->dataSizeTransfered, 0)){
                             *pSDOabortCode = 0x05040004L;
                             SDO_C->state = SDO_STATE_ABORT;
                         }
@@ -1044,6 +1236,10 @@ int8_t CO_SDOclientUpload(
         if (SDO_C->state == SDO_STATE_BLOCKUPLOAD_INPROGRES)
             SDO_C->timeoutTimerBLOCK += timeDifference_ms;
     }
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+    if(SDO_C->state > SDO_STATE_BLOCKUPLOAD_INITIATE && SDO_C->state <= SDO_STATE_BLOCKUPLOAD_BLOCK_END)
+        SDO_C->blockStats.time_ms += timeDifference_ms;
+#endif
     if(SDO_C->timeoutTimer >= SDOtimeoutTime){ /*  comunication TMO */
         *pSDOabortCode = 0x05040000L;    /* SDO protocol timed out */
         CO_SDOclient_abort(SDO_C, *pSDOabortCode);
@@ -1104,10 +1300,28 @@ int8_t CO_SDOclientUpload(
         }
 
         case SDO_STATE_BLOCKUPLOAD_BLOCK_ACK:{
+            /*  pass received segments to the stream consumer */
+            if(SDO_C->pFunctStream){
+                *pSDOabortCode = CO_SDOclient_streamFlush(SDO_C, SDO_C->bufferOffset);
+                if(*pSDOabortCode){
+                    SDO_C->state = SDO_STATE_NOTDEFINED;
+                    CO_SDOclient_abort(SDO_C, *pSDOabortCode);
+                    return SDO_RETURN_END_CLIENTABORT;
+                }
+            }
+
             /*  header */
             SDO_C->CANtxBuff->data[0] = (CCS_UPLOAD_BLOCK<<5) | 0x02;
             SDO_C->CANtxBuff->data[1] = SDO_C->block_seqno;
 
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+            /*  adapt block size to lost segments and receive overflows */
+            SDO_C->blksizeAdaptive = CO_SDO_blksizeAdapt(SDO_C->blksizeAdaptive, SDO_C->block_size_max,
+                    SDO_C->block_seqno < SDO_C->block_blksize || SDO_C->rxOverflowCnt != SDO_C->rxOverflowBlock);
+            SDO_C->blockStats.rxOverflow += SDO_C->rxOverflowCnt - SDO_C->rxOverflowBlock;
+            SDO_C->rxOverflowBlock = SDO_C->rxOverflowCnt;
+#endif
+
             /*  set next block size */
             if (SDO_C->dataSize != 0){
                 if(SDO_C->dataSizeTransfered >= SDO_C->dataSize){
@@ -1116,9 +1330,15 @@ int8_t CO_SDOclientUpload(
                 }
                 else{
                     tmp32 = ((SDO_C->dataSize - SDO_C->dataSizeTransfered) / 7);
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                    if(tmp32 >= SDO_C->blksizeAdaptive){
+                        SDO_C->block_blksize = SDO_C->blksizeAdaptive;
+                    }
+#else
                     if(tmp32 >= SDO_C->block_size_max){
                         SDO_C->block_blksize = SDO_C->block_size_max;
                     }
+#endif
                     else{
                         if((SDO_C->dataSize - SDO_C->dataSizeTransfered) % 7 == 0)
                             SDO_C->block_blksize = tmp32;
@@ -1133,9 +1353,18 @@ int8_t CO_SDOclientUpload(
             else{
                 SDO_C->block_seqno = 0;
                 SDO_C->timeoutTimerBLOCK = 0;
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+                SDO_C->block_blksize = SDO_C->blksizeAdaptive;
+#endif
 
                 SDO_C->state = SDO_STATE_BLOCKUPLOAD_INPROGRES;
             }
+            /*  by streaming one block must fit into buffer */
+            if(SDO_C->pFunctStream && (SDO_C->block_blksize * 7) >= SDO_C->bufferSize)
+                SDO_C->block_blksize = (SDO_C->bufferSize - 1) / 7;
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+            SDO_C->blockStats.blksize = SDO_C->block_blksize;
+#endif
             SDO_C->CANtxBuff->data[2] = SDO_C->block_blksize;
             CO_CANsend(SDO_C->CANdevTx, SDO_C->CANtxBuff);
 
@@ -1147,6 +1376,12 @@ int8_t CO_SDOclientUpload(
 
             CO_CANsend(SDO_C->CANdevTx, SDO_C->CANtxBuff);
 
+#if CO_SDO_BLOCK_ADAPTIVE == 1
+            SDO_C->blockStats.bytes = SDO_C->dataSizeTransfered;
+            SDO_C->blockStats.rxOverflow += SDO_C->rxOverflowCnt - SDO_C->rxOverflowBlock;
+            CO_SDO_blockStatsEnd(&SDO_C->blockStats);
+#endif
+
             *pDataSize = SDO_C->dataSizeTransfered;
             return SDO_RETURN_COMMUNICATION_END;
         }
@@ -1157,3 +1392,215 @@ int8_t CO_SDOclientUpload(
 
     return SDO_RETURN_WAITING_SERVER_RESPONSE;
 }
+
+
+/*******************************************************************************
+ *
+ * ENGINE
+ *
+ ******************************************************************************/
+int16_t CO_SDOclientEngine_init(
+        CO_SDOclientEngine_t   *SDOCE,
+        CO_SDOclient_t        **SDOclients,
+        CO_SDOclientRequest_t **active,
+        uint8_t                 numberOfClients)
+{
+    uint8_t i;
+
+    /* verify parameters */
+    if(SDOclients == 0 || active == 0 || numberOfClients == 0) return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    /* Configure object variables */
+    SDOCE->SDOclients = SDOclients;
+    SDOCE->numberOfClients = numberOfClients;
+    SDOCE->active = active;
+    SDOCE->queueHead = 0;
+    SDOCE->queueTail = 0;
+
+    for(i=0; i<numberOfClients; i++)
+        SDOCE->active[i] = 0;
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+int8_t CO_SDOclientEngine_request(
+        CO_SDOclientEngine_t   *SDOCE,
+        CO_SDOclientRequest_t  *request)
+{
+    /* verify parameters */
+    if(request == 0 || request->nodeId == 0 || request->nodeId > 127 ||
+        request->buffer == 0 || request->bufferSize == 0) return -2;
+
+    request->dataSize = 0;
+    request->abortCode = 0;
+    request->result = SDO_RETURN_WAITING_SERVER_RESPONSE;
+    request->next = 0;
+
+    if(SDOCE->queueTail)
+        SDOCE->queueTail->next = request;
+    else
+        SDOCE->queueHead = request;
+    SDOCE->queueTail = request;
+
+    return 0;
+}
+
+
+/******************************************************************************/
+int8_t CO_SDOclientEngine_DCF(
+        CO_SDOclientEngine_t   *SDOCE,
+        CO_SDOclientRequest_t  *request,
+        uint8_t                 nodeId,
+        uint8_t                *dcf,
+        uint32_t                dcfLength,
+        void                  (*pFunct)(CO_SDOclientRequest_t *request),
+        void                   *object)
+{
+    if(request == 0) return -2;
+
+    request->nodeId = nodeId;
+    request->index = 0x1F22;
+    request->subIndex = nodeId;
+    request->upload = 0;
+    request->blockEnable = 1;
+    request->buffer = dcf;
+    request->bufferSize = dcfLength;
+    request->pFunct = pFunct;
+    request->pFunctStream = 0;
+    request->object = object;
+
+    return CO_SDOclientEngine_request(SDOCE, request);
+}
+
+
+/*
+ * Start request on SDO client channel.
+ *
+ * @return 0 on success, otherwise return code from initiate function.
+ */
+static int8_t CO_SDOclientEngine_start(CO_SDOclient_t *SDO_C, CO_SDOclientRequest_t *req){
+    int8_t ret;
+
+    if(SDO_C->SDOClientPar->nodeIDOfTheSDOServer != req->nodeId){
+        ret = CO_SDOclient_setup(SDO_C, 0, 0, req->nodeId);
+        if(ret) return ret;
+    }
+
+    if(req->upload && req->pFunctStream){
+        ret = CO_SDOclientUploadInitiateStream(SDO_C, req->index, req->subIndex,
+                                               req->buffer, req->bufferSize, req->pFunctStream, req->object);
+    }
+    else if(req->upload){
+        ret = CO_SDOclientUploadInitiate(SDO_C, req->index, req->subIndex,
+                                         req->buffer, req->bufferSize, req->blockEnable);
+        /* buffer too small for block transfer, use segmented */
+        if(ret == -3 && req->blockEnable)
+            ret = CO_SDOclientUploadInitiate(SDO_C, req->index, req->subIndex,
+                                             req->buffer, req->bufferSize, 0);
+    }
+    else{
+        ret = CO_SDOclientDownloadInitiate(SDO_C, req->index, req->subIndex,
+                                           req->buffer, req->bufferSize, req->blockEnable);
+    }
+
+    return ret;
+}
+
+
+/******************************************************************************/
+uint16_t CO_SDOclientEngine_process(
+        CO_SDOclientEngine_t   *SDOCE,
+        uint16_t                timeDifference_ms,
+        uint16_t                SDOtimeoutTime)
+{
+    uint8_t i, j;
+    uint16_t pending = 0;
+    CO_SDOclientRequest_t *req, *prev;
+
+    /* assign queued requests to free channels */
+    prev = 0;
+    req = SDOCE->queueHead;
+    while(req){
+        CO_SDOclientRequest_t *next = req->next;
+        uint8_t freeCh = 0xFF;
+        uint8_t serverBusy = 0;
+
+        for(j=0; j<SDOCE->numberOfClients; j++){
+            if(SDOCE->active[j] == 0){
+                if(freeCh == 0xFF) freeCh = j;
+            }
+            else if(SDOCE->active[j]->nodeId == req->nodeId){
+                serverBusy = 1;
+            }
+        }
+        if(freeCh == 0xFF) break;   /* all channels are busy */
+
+        /* skip request, if its SDO server is already in transfer */
+        if(serverBusy){
+            prev = req;
+            req = next;
+            continue;
+        }
+
+        /* remove request from queue */
+        if(prev) prev->next = next;
+        else     SDOCE->queueHead = next;
+        if(SDOCE->queueTail == req) SDOCE->queueTail = prev;
+        req->next = 0;
+
+        req->result = CO_SDOclientEngine_start(SDOCE->SDOclients[freeCh], req);
+        if(req->result == 0){
+            SDOCE->active[freeCh] = req;
+        }
+        else if(req->pFunct){
+            req->pFunct(req);
+        }
+
+        req = next;
+    }
+
+    /* process active transfers */
+    for(i=0; i<SDOCE->numberOfClients; i++){
+        CO_SDOclient_t *SDO_C = SDOCE->SDOclients[i];
+        uint8_t blockInitiate;
+        int8_t ret;
+
+        req = SDOCE->active[i];
+        if(req == 0) continue;
+
+        if(req->upload){
+            ret = CO_SDOclientUpload(SDO_C, timeDifference_ms, SDOtimeoutTime,
+                                     &req->dataSize, &req->abortCode);
+        }
+        else{
+            blockInitiate = (SDO_C->state == SDO_STATE_BLOCKDOWNLOAD_INITIATE);
+            ret = CO_SDOclientDownload(SDO_C, timeDifference_ms, SDOtimeoutTime,
+                                       &req->abortCode);
+
+            /* block download was refused by server, try segmented */
+            if(ret == SDO_RETURN_END_SERVERABORT && blockInitiate && req->abortCode == 0x05040001L){
+                req->abortCode = 0;
+                ret = CO_SDOclientDownloadInitiate(SDO_C, req->index, req->subIndex,
+                                                   req->buffer, req->bufferSize, 0);
+                if(ret == 0) ret = SDO_RETURN_WAITING_SERVER_RESPONSE;
+            }
+        }
+
+        req->result = ret;
+        if(ret <= 0){
+            /* transfer finished, free the channel before callback */
+            SDOCE->active[i] = 0;
+            if(req->pFunct) req->pFunct(req);
+        }
+        else{
+            pending++;
+        }
+    }
+
+    for(req = SDOCE->queueHead; req; req = req->next)
+        pending++;
+
+    return pending;
+}
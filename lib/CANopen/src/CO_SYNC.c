@@ -28,6 +28,7 @@
 #include "CANopen.h"
 
 #include "CO_driver.h"
+#include "CO_timer.h"
 #include "CO_SDO.h"
 #include "CO_Emergency.h"
 #include "CO_NMT_Heartbeat.h"
@@ -37,6 +38,56 @@
 
 //extern int sync_count;
 
+/*
+ * Save timestamp of SYNC message and update SYNC period jitter statistics.
+ *
+ * Function is called every time, when SYNC message is received or
+ * transmitted, usually from interrupt.
+ */
+static void CO_SYNC_timestamp(CO_SYNC_t *SYNC){
+    uint32_t *jitter = SYNC->jitter;
+    uint32_t period, diff, bin;
+
+    period = getTime_us(&SYNC->timestamp);
+    saveTime(&SYNC->timestamp);
+
+    if(jitter == 0) return;
+
+    /* first SYNC after start or after change of the period */
+    if(!SYNC->jitterTimerValid){
+        SYNC->jitterTimerValid = 1;
+        return;
+    }
+
+    jitter[0]++;
+    if(period < jitter[1]) jitter[1] = period;
+    if(period > jitter[2]) jitter[2] = period;
+
+    if(SYNC->periodTime){
+        diff = (period > SYNC->periodTime) ? (period - SYNC->periodTime) : (SYNC->periodTime - period);
+        bin = diff / CO_SYNC_JITTER_BIN_WIDTH;
+        if(bin > (uint32_t)(SYNC->jitterSize - 4)) bin = SYNC->jitterSize - 4;
+        jitter[3 + bin]++;
+    }
+}
+
+
+/*
+ * Clear SYNC period jitter statistics.
+ */
+static void CO_SYNC_jitterClear(CO_SYNC_t *SYNC){
+    uint8_t i;
+
+    if(SYNC->jitter == 0) return;
+
+    DISABLE_INTERRUPTS();
+    for(i=0; i<SYNC->jitterSize; i++) SYNC->jitter[i] = 0;
+    SYNC->jitter[1] = 0xFFFFFFFFL;
+    SYNC->jitterTimerValid = 0;
+    ENABLE_INTERRUPTS();
+}
+
+
 /*
  * Read received message from CAN module.
  *
@@ -74,6 +125,8 @@ static int16_t CO_SYNC_receive(void *object, CO_CANrxMsg_t *msg){
         //  printf("sync->timer == 0\r\n");
         //sync_count++;
         SYNC->timer = 0;
+        SYNC->SYNCnew = 1;
+        CO_SYNC_timestamp(SYNC);
         
         CO_TIMER_ISR();
     }
@@ -128,6 +181,9 @@ static uint32_t CO_ODF_1005(CO_ODF_arg_t *ODF_arg){
         else{
             SYNC->isProducer = 0;
         }
+#if CO_SYNC_TIMER_PRODUCER == 1
+        SYNC->CANdevTx->txMailboxReserved = SYNC->isProducer;
+#endif
 
         CO_CANrxBufferInit(
                 SYNC->CANdevRx,         /* CAN device */
@@ -167,6 +223,33 @@ static uint32_t CO_ODF_1006(CO_ODF_arg_t *ODF_arg){
 
         SYNC->running = 0;
         SYNC->timer = 0;
+        CO_SYNC_jitterClear(SYNC);
+    }
+
+    return 0;
+}
+
+
+/*
+ * Function for accessing SYNC period jitter statistics from SDO server.
+ *
+ * Writing any value clears the statistics. For more information see file
+ * CO_SDO.h.
+ */
+static uint32_t CO_ODF_SYNCjitter(CO_ODF_arg_t *ODF_arg){
+    CO_SYNC_t *SYNC;
+
+    SYNC = (CO_SYNC_t*) ODF_arg->object;
+
+    if(!ODF_arg->reading && ODF_arg->subIndex > 0){
+        uint8_t *cleared;
+        uint8_t i;
+
+        CO_SYNC_jitterClear(SYNC);
+
+        /* written value will be copied to Object dictionary, replace it */
+        cleared = (uint8_t*) &SYNC->jitter[ODF_arg->subIndex - 1];
+        for(i=0; i<4; i++) ODF_arg->data[i] = cleared[i];
     }
 
     return 0;
@@ -237,8 +320,13 @@ int16_t CO_SYNC_init(
     CANdevTx->curentSyncTimeIsInsideWindow = &SYNC->curentSyncTimeIsInsideWindow; /* parameter inside CAN module. */
 
     SYNC->running = 0;
+    SYNC->SYNCnew = 0;
     SYNC->timer = 0;
     SYNC->counter = 0;
+    SYNC->jitter = 0;
+    SYNC->jitterSize = 0;
+    SYNC->jitterTimerValid = 0;
+    saveTime(&SYNC->timestamp);
 
     SYNC->EM = EM;
     SYNC->operatingState = operatingState;
@@ -270,11 +358,65 @@ int16_t CO_SYNC_init(
             0,                      /* rtr */
             len,                    /* number of data bytes */
             0);                     /* synchronous message flag bit */
+#if CO_SYNC_TIMER_PRODUCER == 1
+    CANdevTx->txMailboxReserved = SYNC->isProducer;
+#endif
 
     return CO_ERROR_NO;
 }
 
 
+/******************************************************************************/
+int16_t CO_SYNC_initJitter(
+        CO_SYNC_t              *SYNC,
+        CO_SDO_t               *SDO,
+        uint32_t               *jitter,
+        uint8_t                 jitterSize,
+        uint16_t                index)
+{
+    /* verify arguments */
+    if(jitter == 0 || jitterSize < 4) return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    SYNC->jitter = jitter;
+    SYNC->jitterSize = jitterSize;
+    CO_SYNC_jitterClear(SYNC);
+
+    CO_OD_configure(SDO, index, CO_ODF_SYNCjitter, (void*)SYNC, 0, 0);
+
+    return CO_ERROR_NO;
+}
+
+
+#if CO_SYNC_TIMER_PRODUCER == 1
+/******************************************************************************/
+uint8_t CO_SYNC_timerISR(CO_SYNC_t *SYNC){
+    uint8_t counter;
+
+    if(*SYNC->operatingState != CO_NMT_OPERATIONAL && *SYNC->operatingState != CO_NMT_PRE_OPERATIONAL)
+        return 0;
+
+    if(!SYNC->isProducer || !SYNC->periodTime)
+        return 0;
+
+    counter = SYNC->counter + 1;
+    if(counter > SYNC->counterOverflowValue) counter = 1;
+    SYNC->CANtxBuff->data[0] = counter;
+
+    /* synchronous PDOs must not act on SYNC, which did not reach the bus */
+    if(CO_CANsendReserved(SYNC->CANdevTx, SYNC->CANtxBuff) != CO_ERROR_NO)
+        return 0;
+
+    SYNC->counter = counter;
+    SYNC->running = 1;
+    SYNC->timer = 0;
+    SYNC->SYNCnew = 1;
+    CO_SYNC_timestamp(SYNC);
+
+    return 1;
+}
+#endif
+
+
 /******************************************************************************/
 uint8_t CO_SYNC_process(
         CO_SYNC_t              *SYNC,
@@ -285,12 +427,12 @@ uint8_t CO_SYNC_process(
     //uint32_t timerNew;
 
     if(*SYNC->operatingState == CO_NMT_OPERATIONAL || *SYNC->operatingState == CO_NMT_PRE_OPERATIONAL){
-        /* was SYNC just received */
-        if(SYNC->running && SYNC->timer == 0)
-            ret = 1;
-
-        /* update sync timer, no overflow */
+        /* was SYNC received or transmitted since the last call, update sync timer */
         DISABLE_INTERRUPTS();
+        if(SYNC->SYNCnew){
+            SYNC->SYNCnew = 0;
+            if(SYNC->running) ret = 1;
+        }
         //timerNew = SYNC->timer + timeDifference_us;
         //if(timerNew > SYNC->timer){
           //sync_count++;
@@ -299,6 +441,7 @@ uint8_t CO_SYNC_process(
         SYNC->timer += timeDifference_us;
         ENABLE_INTERRUPTS();
 
+#if CO_SYNC_TIMER_PRODUCER != 1
         /* SYNC producer */
         if(SYNC->isProducer && SYNC->periodTime){
             if(SYNC->timer >= SYNC->periodTime){
@@ -307,9 +450,11 @@ uint8_t CO_SYNC_process(
                 SYNC->timer = 0;
                 SYNC->CANtxBuff->data[0] = SYNC->counter;
                 CO_CANsend(SYNC->CANdevTx, SYNC->CANtxBuff);
+                CO_SYNC_timestamp(SYNC);
                 ret = 1;
             }
         }
+#endif
 
         /* Synchronous PDOs are allowed only inside time window */
         if(ObjDict_synchronousWindowLength){
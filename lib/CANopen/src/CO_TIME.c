@@ -0,0 +1,390 @@
+/*
+ * CANopen TIME object.
+ *
+ * @file        CO_TIME.c
+ * @ingroup     CO_TIME
+ * @version     SVN: \$Id: CO_TIME.c 32 2013-03-11 08:24:27Z jani22 $
+ * @author      Janez Paternoster
+ * @copyright   2013 Janez Paternoster
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <http://canopennode.sourceforge.net>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "CO_driver.h"
+#include "CO_timer.h"
+#include "CO_SDO.h"
+#include "CO_Emergency.h"
+#include "CO_NMT_Heartbeat.h"
+#include "CO_TIME.h"
+
+
+/*
+ * Copy TIME_OF_DAY from CAN message data into tod.
+ */
+static void CO_TIME_decode(ttimeOfDay *tod, uint8_t *data){
+    memcpySwap4((uint8_t*)&tod->ms, &data[0]);
+    memcpySwap2((uint8_t*)&tod->days, &data[4]);
+    tod->ms &= 0x0FFFFFFFL;
+    tod->us = 0;
+}
+
+
+/*
+ * Copy tod into CAN message data as TIME_OF_DAY.
+ */
+static void CO_TIME_encode(uint8_t *data, ttimeOfDay *tod){
+    memcpySwap4(&data[0], (uint8_t*)&tod->ms);
+    memcpySwap2(&data[4], (uint8_t*)&tod->days);
+}
+
+
+/*
+ * Read received message from CAN module.
+ *
+ * Function will be called (by CAN receive interrupt) every time, when CAN
+ * message with correct identifier will be received. For more information and
+ * description of parameters see file CO_driver.h.
+ */
+static int16_t CO_TIME_receive(void *object, CO_CANrxMsg_t *msg){
+    CO_TIME_t *TIME;
+    uint32_t timestamp;
+
+    timestamp = getTimeNow_us();
+    TIME = (CO_TIME_t*)object;   /* this is the correct pointer type of the first argument */
+
+    if(!TIME->isConsumer)
+        return CO_ERROR_NO;
+
+    if(*TIME->operatingState == CO_NMT_OPERATIONAL || *TIME->operatingState == CO_NMT_PRE_OPERATIONAL){
+        uint8_t i;
+
+        if(msg->DLC == 6){
+            TIME->rxTimestamp = timestamp;
+            for(i=0; i<6; i++) TIME->CANrxData[i] = msg->data[i];
+            TIME->CANrxNew = 1;
+        }
+        else{
+            CO_errorReport(TIME->EM, ERROR_RXMSG_WRONG_LENGTH, msg->DLC);
+        }
+    }
+
+    return CO_ERROR_NO;
+}
+
+
+#if CO_TIME_FOLLOW_UP == 1
+/*
+ * Read received follow-up message from CAN module.
+ *
+ * Function will be called (by CAN receive interrupt) every time, when CAN
+ * message with correct identifier will be received. For more information and
+ * description of parameters see file CO_driver.h.
+ */
+static int16_t CO_TIME_receiveFollowUp(void *object, CO_CANrxMsg_t *msg){
+    CO_TIME_t *TIME;
+
+    TIME = (CO_TIME_t*)object;   /* this is the correct pointer type of the first argument */
+
+    if(!TIME->isConsumer)
+        return CO_ERROR_NO;
+
+    if(*TIME->operatingState == CO_NMT_OPERATIONAL || *TIME->operatingState == CO_NMT_PRE_OPERATIONAL){
+        uint8_t i;
+
+        if(msg->DLC != 8){
+            CO_errorReport(TIME->EM, ERROR_RXMSG_WRONG_LENGTH, msg->DLC);
+            return CO_ERROR_RX_MSG_LENGTH;
+        }
+
+        /* follow-up belongs to the previous TIME message */
+        TIME->rxFollowUpTimestamp = TIME->rxTimestamp;
+        for(i=0; i<8; i++) TIME->CANrxFollowUpData[i] = msg->data[i];
+        TIME->CANrxFollowUpNew = 1;
+    }
+
+    return CO_ERROR_NO;
+}
+
+
+/*
+ * Record the time, when TIME message was handed off to the CAN mailbox.
+ *
+ * Function is called from CAN driver, usually from interrupt. For more
+ * information see file CO_driver.h.
+ */
+static void CO_TIME_handOff(void *object, uint8_t dropped){
+    CO_TIME_t *TIME = (CO_TIME_t*)object;
+
+    if(TIME->txState == 1 && !dropped){
+        TIME->txTimestamp = getTimeNow_us();
+        TIME->txState = 2;
+    }
+}
+#endif
+
+
+/*
+ * Function for accessing _COB ID TIME_ (index 0x1012) from SDO server.
+ *
+ * For more information see file CO_SDO.h.
+ */
+static uint32_t CO_ODF_1012(CO_ODF_arg_t *ODF_arg){
+    CO_TIME_t *TIME;
+    uint32_t *value;
+
+    TIME = (CO_TIME_t*) ODF_arg->object;
+    value = (uint32_t*) ODF_arg->data;
+
+    if(!ODF_arg->reading){
+        uint16_t COB_ID = *value & 0x7FF;
+
+        /* only 11-bit CAN identifier is supported */
+        if(*value & 0x20000000L) return 0x06090030L; /* Invalid value for parameter (download only). */
+
+        /* identifier can not be changed, if TIME object is enabled */
+        if(COB_ID != TIME->COB_ID && (TIME->isConsumer || TIME->isProducer))
+            if((*value & 0xC0000000L) != 0) return 0x08000022L; /* Data cannot be transferred or stored to the application because of the present device state. */
+
+        TIME->isConsumer = (*value & 0x80000000L) ? 1 : 0;
+        TIME->isProducer = (*value & 0x40000000L) ? 1 : 0;
+        TIME->COB_ID = COB_ID;
+        TIME->CANrxNew = 0;
+        TIME->timer = 0;
+#if CO_TIME_FOLLOW_UP == 1
+        TIME->CANrxFollowUpNew = 0;
+        TIME->rxFollowUpTimer = CO_TIME_FOLLOW_UP_TIMEOUT;
+        TIME->txState = 0;
+#endif
+
+        CO_CANrxBufferInit(
+                TIME->CANdevRx,         /* CAN device */
+                TIME->CANdevRxIdx,      /* rx buffer index */
+                TIME->COB_ID,           /* CAN identifier */
+                0x7FF,                  /* mask */
+                0,                      /* rtr */
+                (void*)TIME,            /* object passed to receive function */
+                CO_TIME_receive);       /* this function will process received message */
+
+        TIME->CANtxBuff = CO_CANtxBufferInit(
+                TIME->CANdevTx,         /* CAN device */
+                TIME->CANdevTxIdx,      /* index of specific buffer inside CAN module */
+                TIME->COB_ID,           /* CAN identifier */
+                0,                      /* rtr */
+                6,                      /* number of data bytes */
+                0);                     /* synchronous message flag bit */
+    }
+
+    return 0;
+}
+
+
+/******************************************************************************/
+int16_t CO_TIME_init(
+        CO_TIME_t              *TIME,
+        CO_EM_t                *EM,
+        CO_SDO_t               *SDO,
+        uint8_t                *operatingState,
+        uint32_t                COB_ID_TIMEMessage,
+        uint16_t                periodTime,
+        CO_CANmodule_t         *CANdevRx,
+        uint16_t                CANdevRxIdx,
+        CO_CANmodule_t         *CANdevTx,
+        uint16_t                CANdevTxIdx)
+{
+    /* verify arguments */
+    if(COB_ID_TIMEMessage & 0x20000000L) return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    /* Configure object variables */
+    TIME->isConsumer = (COB_ID_TIMEMessage&0x80000000L) ? 1 : 0;
+    TIME->isProducer = (COB_ID_TIMEMessage&0x40000000L) ? 1 : 0;
+    TIME->COB_ID = COB_ID_TIMEMessage&0x7FF;
+    TIME->periodTime = periodTime;
+    TIME->timer = 0;
+    TIME->CANrxNew = 0;
+    TIME->rxTimestamp = 0;
+#if CO_TIME_FOLLOW_UP == 1
+    TIME->CANrxFollowUpNew = 0;
+    TIME->rxFollowUpTimestamp = 0;
+    TIME->rxFollowUpTimer = CO_TIME_FOLLOW_UP_TIMEOUT;
+    TIME->txState = 0;
+    TIME->txTimestamp = 0;
+    TIME->CANtxFollowUp = 0;
+#endif
+
+    TIME->EM = EM;
+    TIME->operatingState = operatingState;
+    TIME->CANdevRx = CANdevRx;
+    TIME->CANdevRxIdx = CANdevRxIdx;
+
+    /* Configure Object dictionary entry at index 0x1012 */
+    CO_OD_configure(SDO, 0x1012, CO_ODF_1012, (void*)TIME, 0, 0);
+
+    /* configure TIME CAN reception */
+    CO_CANrxBufferInit(
+            CANdevRx,               /* CAN device */
+            CANdevRxIdx,            /* rx buffer index */
+            TIME->COB_ID,           /* CAN identifier */
+            0x7FF,                  /* mask */
+            0,                      /* rtr */
+            (void*)TIME,            /* object passed to receive function */
+            CO_TIME_receive);       /* this function will process received message */
+
+    /* configure TIME CAN transmission */
+    TIME->CANdevTx = CANdevTx;
+    TIME->CANdevTxIdx = CANdevTxIdx;
+    TIME->CANtxBuff = CO_CANtxBufferInit(
+            CANdevTx,               /* CAN device */
+            CANdevTxIdx,            /* index of specific buffer inside CAN module */
+            TIME->COB_ID,           /* CAN identifier */
+            0,                      /* rtr */
+            6,                      /* number of data bytes */
+            0);                     /* synchronous message flag bit */
+#if CO_TIME_FOLLOW_UP == 1
+    TIME->CANtxBuff->object = (void*)TIME;
+    TIME->CANtxBuff->pFunctHandOff = CO_TIME_handOff;
+#endif
+
+    return CO_ERROR_NO;
+}
+
+
+#if CO_TIME_FOLLOW_UP == 1
+/******************************************************************************/
+int16_t CO_TIME_initFollowUp(
+        CO_TIME_t              *TIME,
+        uint16_t                COB_ID_followUp,
+        CO_CANmodule_t         *CANdevRx,
+        uint16_t                CANdevRxIdx,
+        uint16_t                CANdevTxIdx)
+{
+    /* verify arguments, identifiers restricted by CiA 301 are not allowed */
+    if(     COB_ID_followUp <= 0x07F || COB_ID_followUp > 0x7FF ||
+            (COB_ID_followUp >= 0x101 && COB_ID_followUp <= 0x180) ||
+            (COB_ID_followUp >= 0x581 && COB_ID_followUp <= 0x5FF) ||
+            (COB_ID_followUp >= 0x601 && COB_ID_followUp <= 0x67F) ||
+            (COB_ID_followUp >= 0x6E0 && COB_ID_followUp <= 0x6FF) ||
+            COB_ID_followUp >= 0x701 ||
+            COB_ID_followUp == TIME->COB_ID)
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    /* configure follow-up CAN reception */
+    CO_CANrxBufferInit(
+            CANdevRx,               /* CAN device */
+            CANdevRxIdx,            /* rx buffer index */
+            COB_ID_followUp,        /* CAN identifier */
+            0x7FF,                  /* mask */
+            0,                      /* rtr */
+            (void*)TIME,            /* object passed to receive function */
+            CO_TIME_receiveFollowUp);/* this function will process received message */
+
+    /* configure follow-up CAN transmission */
+    TIME->CANtxFollowUp = CO_CANtxBufferInit(
+            TIME->CANdevTx,         /* CAN device */
+            CANdevTxIdx,            /* index of specific buffer inside CAN module */
+            COB_ID_followUp,        /* CAN identifier */
+            0,                      /* rtr */
+            8,                      /* number of data bytes */
+            0);                     /* synchronous message flag bit */
+
+    return CO_ERROR_NO;
+}
+#endif
+
+
+/******************************************************************************/
+uint8_t CO_TIME_process(
+        CO_TIME_t              *TIME,
+        uint16_t                timeDifference_ms)
+{
+    uint8_t ret = 0;
+    ttimeOfDay tod;
+    uint32_t timestamp;
+
+    if(*TIME->operatingState != CO_NMT_OPERATIONAL && *TIME->operatingState != CO_NMT_PRE_OPERATIONAL){
+        TIME->CANrxNew = 0;
+        TIME->timer = 0;
+        return 0;
+    }
+
+    /* TIME consumer */
+    if(TIME->CANrxNew){
+        DISABLE_INTERRUPTS();
+        CO_TIME_decode(&tod, TIME->CANrxData);
+        timestamp = TIME->rxTimestamp;
+        TIME->CANrxNew = 0;
+        ENABLE_INTERRUPTS();
+
+#if CO_TIME_FOLLOW_UP == 1
+        /* while follow-up messages arrive, wait for the more precise one */
+        if(TIME->rxFollowUpTimer >= CO_TIME_FOLLOW_UP_TIMEOUT || getTimeOfDay(timestamp, &tod) != 0)
+#endif
+        if(setTimeOfDay(timestamp, &tod) == 0) ret = 1;
+    }
+
+#if CO_TIME_FOLLOW_UP == 1
+    if((uint16_t)(CO_TIME_FOLLOW_UP_TIMEOUT - TIME->rxFollowUpTimer) > timeDifference_ms)
+        TIME->rxFollowUpTimer += timeDifference_ms;
+    else
+        TIME->rxFollowUpTimer = CO_TIME_FOLLOW_UP_TIMEOUT;
+
+    if(TIME->CANrxFollowUpNew){
+        TIME->rxFollowUpTimer = 0;
+        DISABLE_INTERRUPTS();
+        CO_TIME_decode(&tod, TIME->CANrxFollowUpData);
+        memcpySwap2((uint8_t*)&tod.us, &TIME->CANrxFollowUpData[6]);
+        timestamp = TIME->rxFollowUpTimestamp;
+        TIME->CANrxFollowUpNew = 0;
+        ENABLE_INTERRUPTS();
+
+        if(setTimeOfDay(timestamp, &tod) == 0) ret = 1;
+    }
+#endif
+
+    /* TIME producer */
+    if(!TIME->isProducer || TIME->periodTime == 0)
+        return ret;
+
+#if CO_TIME_FOLLOW_UP == 1
+    /* send time of day at the moment, when TIME message was handed off */
+    if(TIME->txState == 2 && TIME->CANtxFollowUp && !TIME->CANtxFollowUp->bufferFull){
+        TIME->txState = 0;
+        if(getTimeOfDay(TIME->txTimestamp, &tod) == 0){
+            CO_TIME_encode(TIME->CANtxFollowUp->data, &tod);
+            memcpySwap2(&TIME->CANtxFollowUp->data[6], (uint8_t*)&tod.us);
+            CO_CANsend(TIME->CANdevTx, TIME->CANtxFollowUp);
+        }
+    }
+#endif
+
+    if(TIME->timer < TIME->periodTime) TIME->timer += timeDifference_ms;
+    /* previous TIME message must leave the transmit buffer first */
+    if(TIME->timer >= TIME->periodTime && !TIME->CANtxBuff->bufferFull){
+        /* clock must be set by the application first */
+        if(getTimeOfDay(getTimeNow_us(), &tod) == 0){
+            TIME->timer = 0;
+            CO_TIME_encode(TIME->CANtxBuff->data, &tod);
+#if CO_TIME_FOLLOW_UP == 1
+            if(TIME->CANtxFollowUp) TIME->txState = 1;
+#endif
+            CO_CANsend(TIME->CANdevTx, TIME->CANtxBuff);
+        }
+    }
+
+    return ret;
+}
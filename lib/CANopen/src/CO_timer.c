@@ -15,20 +15,140 @@ int initTimer(pf_getTimerVal_us gett) {
 }
 
 void saveTime(ttimer *tim) {
-	if (!tim)
+	if (!tim || !gettimerfunc)
 		return;
 	tim->savedTime = gettimerfunc();
 }
 
 uint32_t getTime_ms(ttimer *tim) {
-	if (!tim)
+	if (!tim || !gettimerfunc)
 		return 0;
 	return (gettimerfunc() - tim->savedTime) / 1000;
 }
 
+uint32_t getTimeNow_us(void) {
+	if (!gettimerfunc)
+		return 0;
+	return gettimerfunc();
+}
+
 uint32_t getTime_us(ttimer *tim) {
-	if (!tim)
+	if (!tim || !gettimerfunc)
 		return 0;
 	uint32_t now = gettimerfunc();
 	return (now - tim->savedTime);
 }
+
+#define TOD_MS_PER_DAY		86400000L
+#define TOD_STEP_LIMIT_US	1000000L	/* larger error steps the clock */
+#define TOD_RATE_LIMIT_PPM	500L
+#define TOD_REANCHOR_US		600000000L	/* re-anchor reference after 10 min */
+
+static uint8_t todValid = 0;
+static ttimeOfDay todRef;		/* time of day at todRefLocal */
+static uint32_t todRefLocal;	/* local timer value of the reference, us */
+static int32_t todRate = 0;		/* rate correction of the local timer, ppm */
+
+/* add signed number of microseconds to the time of day */
+static void todAdd(ttimeOfDay *tod, int32_t delta_us) {
+	int32_t ms = delta_us / 1000;
+	int32_t us = (int32_t)tod->us + delta_us % 1000;
+
+	if (us < 0) {
+		us += 1000;
+		ms--;
+	} else if (us >= 1000) {
+		us -= 1000;
+		ms++;
+	}
+	tod->us = (uint16_t)us;
+
+	ms += (int32_t)tod->ms;
+	while (ms < 0) {
+		ms += TOD_MS_PER_DAY;
+		tod->days--;
+	}
+	while (ms >= TOD_MS_PER_DAY) {
+		ms -= TOD_MS_PER_DAY;
+		tod->days++;
+	}
+	tod->ms = (uint32_t)ms;
+}
+
+/* difference a - b in microseconds, saturated to +-2000 s */
+static int32_t todDiff(const ttimeOfDay *a, const ttimeOfDay *b) {
+	int32_t days = (int32_t)a->days - (int32_t)b->days;
+	int32_t ms;
+
+	if (days > 1 || days < -1)
+		return days > 0 ? 2000000000L : -2000000000L;
+	ms = (int32_t)a->ms - (int32_t)b->ms + days * TOD_MS_PER_DAY;
+	if (ms > 2000000L)
+		return 2000000000L;
+	if (ms < -2000000L)
+		return -2000000000L;
+	return ms * 1000 + ((int32_t)a->us - (int32_t)b->us);
+}
+
+/* local time elapsed since the reference, corrected by the rate */
+static int32_t todElapsed(uint32_t localTime_us) {
+	int32_t elapsed = (int32_t)(localTime_us - todRefLocal);
+	return elapsed + (elapsed / 1000) * todRate / 1000;
+}
+
+int setTimeOfDay(uint32_t localTime_us, const ttimeOfDay *tod) {
+	ttimeOfDay predicted;
+	int32_t interval, err;
+
+	if (!tod || tod->ms >= TOD_MS_PER_DAY || tod->us >= 1000)
+		return -1;
+
+	DISABLE_INTERRUPTS();
+	if (todValid) {
+		predicted = todRef;
+		todAdd(&predicted, todElapsed(localTime_us));
+		err = todDiff(tod, &predicted);
+		interval = (int32_t)(localTime_us - todRefLocal);
+
+		if (err > TOD_STEP_LIMIT_US || err < -TOD_STEP_LIMIT_US || interval <= 0) {
+			todRate = 0;
+		} else if (interval >= 1000) {
+			/* correct the rate by half of the measured error, in ppm */
+			todRate += (err / 2) * 1000 / (interval / 1000);
+			if (todRate > TOD_RATE_LIMIT_PPM)
+				todRate = TOD_RATE_LIMIT_PPM;
+			else if (todRate < -TOD_RATE_LIMIT_PPM)
+				todRate = -TOD_RATE_LIMIT_PPM;
+		}
+	} else {
+		todRate = 0;
+	}
+	todRef = *tod;
+	todRefLocal = localTime_us;
+	todValid = 1;
+	ENABLE_INTERRUPTS();
+	return 0;
+}
+
+int getTimeOfDay(uint32_t localTime_us, ttimeOfDay *tod) {
+	int32_t elapsed;
+
+	if (!tod || !todValid)
+		return -1;
+
+	DISABLE_INTERRUPTS();
+	elapsed = todElapsed(localTime_us);
+	*tod = todRef;
+	todAdd(tod, elapsed);
+	/* keep the elapsed time in range of int32 */
+	if (elapsed > TOD_REANCHOR_US) {
+		todRef = *tod;
+		todRefLocal = localTime_us;
+	}
+	ENABLE_INTERRUPTS();
+	return 0;
+}
+
+int32_t getTimeOfDayRate_ppm(void) {
+	return todRate;
+}
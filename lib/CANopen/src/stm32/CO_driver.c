@@ -203,6 +203,7 @@ int16_t CO_CANmodule_init(
     CANmodule->curentSyncTimeIsInsideWindow = 0;
     CANmodule->bufferInhibitFlag = 0;
     CANmodule->transmittingAborted = 0;
+    CANmodule->txMailboxReserved = 0;
     CANmodule->firstCANtxMessage = 1;
     CANmodule->CANtxCount = 0;
     CANmodule->errOld = 0;
@@ -212,10 +213,12 @@ int16_t CO_CANmodule_init(
 
     for (i = 0; i < rxSize; i++) {
         CANmodule->rxArray[i].ident = 0;
+        CANmodule->rxArray[i].mask = 0xFFFF;    /* unused buffer must not catch messages */
         CANmodule->rxArray[i].pFunct = 0;
     }
     for (i = 0; i < txSize; i++) {
         CANmodule->txArray[i].bufferFull = 0;
+        CANmodule->txArray[i].pFunctHandOff = 0;
     }
 
     /* Setting Clock of CAN HW */
@@ -352,7 +355,8 @@ void CO_CANmodule_disable(CO_CANmodule_t *CANmodule){
 
 /******************************************************************************/
 uint16_t CO_CANrxMsg_readIdent(CO_CANrxMsg_t *rxMsg) {
-    return (rxMsg->ident >> 2) & 0x7FF;
+    /* ident holds standard identifier, see CO_CANrecFromModule() */
+    return rxMsg->ident & 0x7FF;
 }
 
 /******************************************************************************/
@@ -427,7 +431,10 @@ CO_CANtx_t *CO_CANtxBufferInit(
 
 int8_t getFreeTxBuff(CO_CANmodule_t *CANmodule) {
 	uint8_t txBuff = 0;
-	for (txBuff = 0; txBuff <= 3; txBuff++)
+	for (txBuff = 0; txBuff <= 3; txBuff++) {
+		//mailbox reserved for CO_CANsendReserved() is not used here
+		if (CANmodule->txMailboxReserved && txBuff == CO_CAN_TX_MAILBOX_RESERVED)
+			continue;
 		//if (CAN_TransmitStatus(CANmodule->CANbaseAddress, txBuff) == CAN_TxStatus_Ok)
 		switch (txBuff) {
 		case (CAN_TXMAILBOX_0 ):
@@ -446,6 +453,7 @@ int8_t getFreeTxBuff(CO_CANmodule_t *CANmodule) {
 			else
 				break;
 		}
+	}
 	return -1;
 }
 
@@ -457,8 +465,13 @@ int16_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer) {
     //TODO:  if(CAN_REG(addr, C_TXBUF0 + C_TXCON) & 0x40){CANmodule->transmittingAborted--; CAN_REG(addr, C_INTF) |= 0x04;}
    }
   
+   //CO_CANsend() may also be called from receive interrupt (SDO fast upload,
+   //TPDO on RTR), so buffer state and mailbox are checked in critical section
+   DISABLE_INTERRUPTS();
+
    //Was previous message sent or it is still waiting?
    if(buffer->bufferFull){
+      ENABLE_INTERRUPTS();
       if(!CANmodule->firstCANtxMessage)//don't set error, if bootup message is still on buffers
          CO_errorReport((CO_EM_t*)CANmodule->EM, ERROR_CAN_TX_OVERFLOW, 0);
       return CO_ERROR_TX_OVERFLOW;
@@ -466,6 +479,8 @@ int16_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer) {
 
    //messages with syncFlag set (synchronous PDOs) must be transmited inside preset time window
    if(CANmodule->curentSyncTimeIsInsideWindow && buffer->syncFlag && !(*CANmodule->curentSyncTimeIsInsideWindow)){
+      ENABLE_INTERRUPTS();
+      if(buffer->pFunctHandOff) buffer->pFunctHandOff(buffer->object, 1);
       CO_errorReport((CO_EM_t*)CANmodule->EM, ERROR_TPDO_OUTSIDE_WINDOW, 0);
       return CO_ERROR_TX_PDO_WINDOW;
    }
@@ -484,15 +499,40 @@ int16_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer) {
       // vsechny buffery jsou plny, musime povolit preruseni od vysilace, odvysilat az v preruseni
       CAN_ITConfig(CANmodule->CANbaseAddress, CAN_IT_TME, ENABLE);
    }
-   
+
+   ENABLE_INTERRUPTS();
+
    return CO_ERROR_NO;
 }
+
+/******************************************************************************/
+int16_t CO_CANsendReserved(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer) {
+    if (!CANmodule->txMailboxReserved)
+        return CO_CANsend(CANmodule, buffer);
+
+    DISABLE_INTERRUPTS();
+    //previous message from reserved mailbox was not sent yet
+    if (!(CANmodule->CANbaseAddress->TSR & CAN_TSR_TME2)) {
+        ENABLE_INTERRUPTS();
+        CO_errorReport((CO_EM_t*)CANmodule->EM, ERROR_CAN_TX_OVERFLOW, 0);
+        return CO_ERROR_TX_OVERFLOW;
+    }
+    CO_CANsendToModule(CANmodule, buffer, CO_CAN_TX_MAILBOX_RESERVED);
+    ENABLE_INTERRUPTS();
+
+    return CO_ERROR_NO;
+}
+
 /******************************************************************************/
 void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule) {
     DISABLE_INTERRUPTS();
 
     if (CANmodule->bufferInhibitFlag) {
-        CANmodule->CANbaseAddress->TSR |= CAN_TSR_ABRQ0 | CAN_TSR_ABRQ1 | CAN_TSR_ABRQ2;
+        //message in reserved mailbox is not synchronous PDO
+        if (CANmodule->txMailboxReserved)
+            CANmodule->CANbaseAddress->TSR |= CAN_TSR_ABRQ0 | CAN_TSR_ABRQ1;
+        else
+            CANmodule->CANbaseAddress->TSR |= CAN_TSR_ABRQ0 | CAN_TSR_ABRQ1 | CAN_TSR_ABRQ2;
         ENABLE_INTERRUPTS();
         CO_errorReport((CO_EM_t*) CANmodule->EM, ERROR_TPDO_OUTSIDE_WINDOW, 0);
     } else
@@ -633,6 +673,7 @@ void CO_CANinterrupt_Tx(CO_CANmodule_t *CANmodule) {
                 CANmodule->bufferInhibitFlag = 0;
                 if (CANmodule->curentSyncTimeIsInsideWindow && buffer->syncFlag) {
                     if (!(*CANmodule->curentSyncTimeIsInsideWindow)) {
+                        if (buffer->pFunctHandOff) buffer->pFunctHandOff(buffer->object, 1);
                         CO_errorReport((CO_EM_t*) CANmodule->EM, ERROR_TPDO_OUTSIDE_WINDOW, 0);
                         //release buffer
                         buffer->bufferFull = 0;
@@ -687,5 +728,6 @@ void CO_CANsendToModule(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer, uint8_t t
         //printf("CO_CANsendToModule - TDHR: 0x%X\r\n", CANmodule->CANbaseAddress->sTxMailBox[transmit_mailbox].TDHR);
         CANmodule->CANbaseAddress->sTxMailBox[transmit_mailbox].TIR |= TMIDxR_TXRQ;
         //printf("CO_CANsendToModule - 4\r\n");
+        if (buffer->pFunctHandOff) buffer->pFunctHandOff(buffer->object, 0);
     }
 }
@@ -78,19 +78,21 @@
 /*******************************************************************************
    FEATURES
 *******************************************************************************/
-   #define CO_NO_SYNC                     1   //Associated objects: 1005, 1006, 1007, 2103, 2104
+   #define CO_NO_SYNC                     1   //Associated objects: 1005, 1006, 1007, 2103, 2104, 2108
+   #define CO_NO_TIME                     1   //Associated objects: 1012
    #define CO_NO_EMERGENCY                1   //Associated objects: 1014, 1015
+   #define CO_NO_EM_CONS                  1   //Associated objects: 1028
    #define CO_NO_SDO_SERVER               1   //Associated objects: 1200
    #define CO_NO_SDO_CLIENT               0   
-   #define CO_NO_RPDO                     4   //Associated objects: 1400, 1401, 1402, 1403, 1600, 1601, 1602, 1603
-   #define CO_NO_TPDO                     4   //Associated objects: 1800, 1801, 1802, 1803, 1A00, 1A01, 1A02, 1A03
+   #define CO_NO_RPDO                     4   //Associated objects: 1400, 1401, 1402, 1403, 1600, 1601, 1602, 1603, 2118, 2119, 211A, 211B
+   #define CO_NO_TPDO                     4   //Associated objects: 1800, 1801, 1802, 1803, 1A00, 1A01, 1A02, 1A03, 2110, 2111, 2112, 2113, 2114, 2115, 2116
    #define CO_NO_NMT_MASTER               0   
 
 
 /*******************************************************************************
    OBJECT DICTIONARY
 *******************************************************************************/
-   #define CO_OD_NoOfElements             114
+   #define CO_OD_NoOfElements             129
 
 
 /*******************************************************************************
@@ -114,6 +116,9 @@
                UNSIGNED8      maxSubIndex;
                UNSIGNED32     COB_IDUsedByRPDO;
                UNSIGNED8      transmissionType;
+               UNSIGNED16     inhibitTime;
+               UNSIGNED8      compatibilityEntry;
+               UNSIGNED16     eventTimer;
                }              OD_RPDOCommunicationParameter_t;
 
 /*1600[4]   */ typedef struct{
@@ -171,6 +176,12 @@ struct sCO_OD_RAM{
 /*2105      */ UNSIGNED8      OPERATING_MODE;
 /*2106      */ UNSIGNED8      OPERATING_MODE_DISPLAY;
 /*2107      */ UNSIGNED8      STATUS_CODE;
+/*2108      */ UNSIGNED32     SYNCJitter[10];
+/*2110[4]   */ UNSIGNED32     TPDOSYNCLatency[4][10];
+/*2114      */ UNSIGNED32     TPDOSYNCOffset[4];
+/*2115      */ UNSIGNED32     TPDOEventTimeUs[4];
+/*2116      */ UNSIGNED8      TPDOGroup[4];
+/*2118[4]   */ UNSIGNED32     RPDOStatistics[4][7];
 /*2200      */ INTEGER16      JOINT_FORCE_CONSTANT;
 /*2201      */ INTEGER16      JOINT_POSITION_CONSTANT;
 /*2202      */ INTEGER16      JOINT_VELOCITY_CONSTANT;
@@ -265,12 +276,14 @@ struct sCO_OD_ROM{
 /*1008      */ VISIBLE_STRING manufacturerDeviceName[8];
 /*1009      */ VISIBLE_STRING manufacturerHardwareVersion[4];
 /*100A      */ VISIBLE_STRING manufacturerSoftwareVersion[4];
+/*1012      */ UNSIGNED32     COB_ID_TIME;
 /*1014      */ UNSIGNED32     COB_ID_EMCY;
 /*1015      */ UNSIGNED16     inhibitTimeEMCY;
-/*1016      */ UNSIGNED32     consumerHeartbeatTime[4];
+/*1016      */ UNSIGNED32     consumerHeartbeatTime[127];
 /*1017      */ UNSIGNED16     producerHeartbeatTime;
 /*1018      */ OD_identity_t  identity;
 /*1019      */ UNSIGNED8      synchronousCounterOverflowValue;
+/*1028      */ UNSIGNED32     emergencyConsumer[127];
 /*1029      */ UNSIGNED8      errorBehavior[6];
 /*1200[1]   */ OD_SDOServerParameter_t SDOServerParameter[1];
 /*1400[4]   */ OD_RPDOCommunicationParameter_t RPDOCommunicationParameter[4];
@@ -340,15 +353,18 @@ extern struct sCO_OD_ROM CO_OD_ROM;
       #define ODL_restoreDefaultParameters_arrayLength   1
       #define ODA_restoreDefaultParameters_restoreAllDefaultParameters 0
 
+/*1012, Data Type: UNSIGNED32 */
+      #define OD_COB_ID_TIME                             CO_OD_ROM.COB_ID_TIME
+
 /*1014, Data Type: UNSIGNED32 */
       #define OD_COB_ID_EMCY                             CO_OD_ROM.COB_ID_EMCY
 
 /*1015, Data Type: UNSIGNED16 */
       #define OD_inhibitTimeEMCY                         CO_OD_ROM.inhibitTimeEMCY
 
-/*1016, Data Type: UNSIGNED32, Array[4] */
+/*1016, Data Type: UNSIGNED32, Array[127] */
       #define OD_consumerHeartbeatTime                   CO_OD_ROM.consumerHeartbeatTime
-      #define ODL_consumerHeartbeatTime_arrayLength      4
+      #define ODL_consumerHeartbeatTime_arrayLength      127
 
 /*1017, Data Type: UNSIGNED16 */
       #define OD_producerHeartbeatTime                   CO_OD_ROM.producerHeartbeatTime
@@ -359,6 +375,10 @@ extern struct sCO_OD_ROM CO_OD_ROM;
 /*1019, Data Type: UNSIGNED8 */
       #define OD_synchronousCounterOverflowValue         CO_OD_ROM.synchronousCounterOverflowValue
 
+/*1028, Data Type: UNSIGNED32, Array[127] */
+      #define OD_emergencyConsumer                       CO_OD_ROM.emergencyConsumer
+      #define ODL_emergencyConsumer_arrayLength          127
+
 /*1029, Data Type: UNSIGNED8, Array[6] */
       #define OD_errorBehavior                           CO_OD_ROM.errorBehavior
       #define ODL_errorBehavior_arrayLength              6
@@ -412,6 +432,30 @@ extern struct sCO_OD_ROM CO_OD_ROM;
 /*2107, Data Type: UNSIGNED8 */
       #define OD_STATUS_CODE                             CO_OD_RAM.STATUS_CODE
 
+/*2108, Data Type: UNSIGNED32, Array[10] */
+      #define OD_SYNCJitter                              CO_OD_RAM.SYNCJitter
+      #define ODL_SYNCJitter_arrayLength                 10
+
+/*2110[4], Data Type: UNSIGNED32, Array[10] */
+      #define OD_TPDOSYNCLatency                         CO_OD_RAM.TPDOSYNCLatency
+      #define ODL_TPDOSYNCLatency_arrayLength            10
+
+/*2114, Data Type: UNSIGNED32, Array[4] */
+      #define OD_TPDOSYNCOffset                          CO_OD_RAM.TPDOSYNCOffset
+      #define ODL_TPDOSYNCOffset_arrayLength             4
+
+/*2115, Data Type: UNSIGNED32, Array[4] */
+      #define OD_TPDOEventTimeUs                         CO_OD_RAM.TPDOEventTimeUs
+      #define ODL_TPDOEventTimeUs_arrayLength            4
+
+/*2116, Data Type: UNSIGNED8, Array[4] */
+      #define OD_TPDOGroup                               CO_OD_RAM.TPDOGroup
+      #define ODL_TPDOGroup_arrayLength                  4
+
+/*2118[4], Data Type: UNSIGNED32, Array[7] */
+      #define OD_RPDOStatistics                          CO_OD_RAM.RPDOStatistics
+      #define ODL_RPDOStatistics_arrayLength             7
+
 /*2200, Data Type: INTEGER16 */
       #define OD_JOINT_FORCE_CONSTANT                    CO_OD_RAM.JOINT_FORCE_CONSTANT
 
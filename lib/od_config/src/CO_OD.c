@@ -59,6 +59,18 @@ struct sCO_OD_RAM CO_OD_RAM = {
 /*2105*/ 0x0,
 /*2106*/ 0x0,
 /*2107*/ 0x0,
+/*2108*/ {0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
+/*2110*/ {{0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
+          {0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
+          {0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
+          {0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L}},
+/*2114*/ {0x0L, 0x0L, 0x0L, 0x0L},
+/*2115*/ {0x0L, 0x0L, 0x0L, 0x0L},
+/*2116*/ {0x0, 0x0, 0x0, 0x0},
+/*2118*/ {{0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
+          {0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
+          {0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
+          {0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L}},
 /*2200*/ 0,
 /*2201*/ 0,
 /*2202*/ 0,
@@ -154,18 +166,20 @@ struct sCO_OD_EEPROM CO_OD_EEPROM = {
 /*1008*/ {'E', 'X', 'T', 'R', 'E', 'M', 'I', 'S'},
 /*1009*/ {'1', '.', '0', '0'},
 /*100A*/ {'1', '.', '0', '0'},
+/*1012*/ 0x80000100L,
 /*1014*/ 0x80L,
 /*1015*/ 0x64,
-/*1016*/ {0x0L, 0x0L, 0x0L, 0x0L},
+/*1016*/ {0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
 /*1017*/ 0x0,
 /*1018*/ {0x4, 0x0L, 0x0L, 0x0L, 0x0L},
 /*1019*/ 0x0,
+/*1028*/ {0x80000081L, 0x80000082L, 0x80000083L, 0x80000084L, 0x80000085L, 0x80000086L, 0x80000087L, 0x80000088L, 0x80000089L, 0x8000008AL, 0x8000008BL, 0x8000008CL, 0x8000008DL, 0x8000008EL, 0x8000008FL, 0x80000090L, 0x80000091L, 0x80000092L, 0x80000093L, 0x80000094L, 0x80000095L, 0x80000096L, 0x80000097L, 0x80000098L, 0x80000099L, 0x8000009AL, 0x8000009BL, 0x8000009CL, 0x8000009DL, 0x8000009EL, 0x8000009FL, 0x800000A0L, 0x800000A1L, 0x800000A2L, 0x800000A3L, 0x800000A4L, 0x800000A5L, 0x800000A6L, 0x800000A7L, 0x800000A8L, 0x800000A9L, 0x800000AAL, 0x800000ABL, 0x800000ACL, 0x800000ADL, 0x800000AEL, 0x800000AFL, 0x800000B0L, 0x800000B1L, 0x800000B2L, 0x800000B3L, 0x800000B4L, 0x800000B5L, 0x800000B6L, 0x800000B7L, 0x800000B8L, 0x800000B9L, 0x800000BAL, 0x800000BBL, 0x800000BCL, 0x800000BDL, 0x800000BEL, 0x800000BFL, 0x800000C0L, 0x800000C1L, 0x800000C2L, 0x800000C3L, 0x800000C4L, 0x800000C5L, 0x800000C6L, 0x800000C7L, 0x800000C8L, 0x800000C9L, 0x800000CAL, 0x800000CBL, 0x800000CCL, 0x800000CDL, 0x800000CEL, 0x800000CFL, 0x800000D0L, 0x800000D1L, 0x800000D2L, 0x800000D3L, 0x800000D4L, 0x800000D5L, 0x800000D6L, 0x800000D7L, 0x800000D8L, 0x800000D9L, 0x800000DAL, 0x800000DBL, 0x800000DCL, 0x800000DDL, 0x800000DEL, 0x800000DFL, 0x800000E0L, 0x800000E1L, 0x800000E2L, 0x800000E3L, 0x800000E4L, 0x800000E5L, 0x800000E6L, 0x800000E7L, 0x800000E8L, 0x800000E9L, 0x800000EAL, 0x800000EBL, 0x800000ECL, 0x800000EDL, 0x800000EEL, 0x800000EFL, 0x800000F0L, 0x800000F1L, 0x800000F2L, 0x800000F3L, 0x800000F4L, 0x800000F5L, 0x800000F6L, 0x800000F7L, 0x800000F8L, 0x800000F9L, 0x800000FAL, 0x800000FBL, 0x800000FCL, 0x800000FDL, 0x800000FEL, 0x800000FFL},
 /*1029*/ {0x1, 0x0, 0x1, 0x0, 0x0, 0x0},
 /*1200*/{{0x2, 0x600L, 0x580L}},
-/*1400*/{{0x2, 0x200L, 0xFF},
-/*1401*/ {0x2, 0x300L, 0xFE},
-/*1402*/ {0x2, 0x400L, 0xFE},
-/*1403*/ {0x2, 0x500L, 0xFE}},
+/*1400*/{{0x5, 0x200L, 0xFF, 0x0, 0x0, 0x0},
+/*1401*/ {0x5, 0x300L, 0xFE, 0x0, 0x0, 0x0},
+/*1402*/ {0x5, 0x400L, 0xFE, 0x0, 0x0, 0x0},
+/*1403*/ {0x5, 0x500L, 0xFE, 0x0, 0x0, 0x0}},
 /*1600*/{{0x0, 0x62000108L, 0x62000208L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
 /*1601*/ {0x0, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
 /*1602*/ {0x0, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
@@ -199,22 +213,34 @@ struct sCO_OD_EEPROM CO_OD_EEPROM = {
            {(void*)&CO_OD_ROM.SDOServerParameter[0].maxSubIndex, 0x05,  1},
            {(void*)&CO_OD_ROM.SDOServerParameter[0].COB_IDClientToServer, 0x85,  4},
            {(void*)&CO_OD_ROM.SDOServerParameter[0].COB_IDServerToClient, 0x85,  4}};
-/*0x1400*/ const CO_OD_entryRecord_t OD_record1400[3] = {
+/*0x1400*/ const CO_OD_entryRecord_t OD_record1400[6] = {
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].maxSubIndex, 0x05,  1},
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].COB_IDUsedByRPDO, 0x8D,  4},
-           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].transmissionType, 0x0D,  1}};
-/*0x1401*/ const CO_OD_entryRecord_t OD_record1401[3] = {
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].transmissionType, 0x0D,  1},
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].inhibitTime, 0x8D,  2},
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].compatibilityEntry, 0x0D,  1},
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].eventTimer, 0x8D,  2}};
+/*0x1401*/ const CO_OD_entryRecord_t OD_record1401[6] = {
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].maxSubIndex, 0x05,  1},
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].COB_IDUsedByRPDO, 0x8D,  4},
-           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].transmissionType, 0x0D,  1}};
-/*0x1402*/ const CO_OD_entryRecord_t OD_record1402[3] = {
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].transmissionType, 0x0D,  1},
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].inhibitTime, 0x8D,  2},
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].compatibilityEntry, 0x0D,  1},
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].eventTimer, 0x8D,  2}};
+/*0x1402*/ const CO_OD_entryRecord_t OD_record1402[6] = {
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].maxSubIndex, 0x05,  1},
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].COB_IDUsedByRPDO, 0x8D,  4},
-           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].transmissionType, 0x0D,  1}};
-/*0x1403*/ const CO_OD_entryRecord_t OD_record1403[3] = {
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].transmissionType, 0x0D,  1},
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].inhibitTime, 0x8D,  2},
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].compatibilityEntry, 0x0D,  1},
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].eventTimer, 0x8D,  2}};
+/*0x1403*/ const CO_OD_entryRecord_t OD_record1403[6] = {
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].maxSubIndex, 0x05,  1},
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].COB_IDUsedByRPDO, 0x8D,  4},
-           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].transmissionType, 0x0D,  1}};
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].transmissionType, 0x0D,  1},
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].inhibitTime, 0x8D,  2},
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].compatibilityEntry, 0x0D,  1},
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].eventTimer, 0x8D,  2}};
 /*0x1600*/ const CO_OD_entryRecord_t OD_record1600[9] = {
            {(void*)&CO_OD_ROM.RPDOMappingParameter[0].numberOfMappedObjects, 0x0D,  1},
            {(void*)&CO_OD_ROM.RPDOMappingParameter[0].mappedObject1, 0x8D,  4},
@@ -345,18 +371,20 @@ const CO_OD_entry_t CO_OD[CO_OD_NoOfElements] = {
 {0x100A, 0x00, 0x05,  4, (void*)&CO_OD_ROM.manufacturerSoftwareVersion[0]},
 {0x1010, 0x01, 0x8E,  4, (void*)&CO_OD_RAM.storeParameters[0]},
 {0x1011, 0x01, 0x8E,  4, (void*)&CO_OD_RAM.restoreDefaultParameters[0]},
+{0x1012, 0x00, 0x8D,  4, (void*)&CO_OD_ROM.COB_ID_TIME},
 {0x1014, 0x00, 0x85,  4, (void*)&CO_OD_ROM.COB_ID_EMCY},
 {0x1015, 0x00, 0x8D,  2, (void*)&CO_OD_ROM.inhibitTimeEMCY},
-{0x1016, 0x04, 0x8D,  4, (void*)&CO_OD_ROM.consumerHeartbeatTime[0]},
+{0x1016, 0x7F, 0x8D,  4, (void*)&CO_OD_ROM.consumerHeartbeatTime[0]},
 {0x1017, 0x00, 0x8D,  2, (void*)&CO_OD_ROM.producerHeartbeatTime},
 {0x1018, 0x04, 0x00,  0, (void*)&OD_record1018},
 {0x1019, 0x00, 0x0D,  1, (void*)&CO_OD_ROM.synchronousCounterOverflowValue},
+{0x1028, 0x7F, 0x8D,  4, (void*)&CO_OD_ROM.emergencyConsumer[0]},
 {0x1029, 0x06, 0x0D,  1, (void*)&CO_OD_ROM.errorBehavior[0]},
 {0x1200, 0x02, 0x00,  0, (void*)&OD_record1200},
-{0x1400, 0x02, 0x00,  0, (void*)&OD_record1400},
-{0x1401, 0x02, 0x00,  0, (void*)&OD_record1401},
-{0x1402, 0x02, 0x00,  0, (void*)&OD_record1402},
-{0x1403, 0x02, 0x00,  0, (void*)&OD_record1403},
+{0x1400, 0x05, 0x00,  0, (void*)&OD_record1400},
+{0x1401, 0x05, 0x00,  0, (void*)&OD_record1401},
+{0x1402, 0x05, 0x00,  0, (void*)&OD_record1402},
+{0x1403, 0x05, 0x00,  0, (void*)&OD_record1403},
 {0x1600, 0x08, 0x00,  0, (void*)&OD_record1600},
 {0x1601, 0x08, 0x00,  0, (void*)&OD_record1601},
 {0x1602, 0x08, 0x00,  0, (void*)&OD_record1602},
@@ -369,6 +397,7 @@ const CO_OD_entry_t CO_OD[CO_OD_NoOfElements] = {
 {0x1A01, 0x08, 0x00,  0, (void*)&OD_record1A01},
 {0x1A02, 0x08, 0x00,  0, (void*)&OD_record1A02},
 {0x1A03, 0x08, 0x00,  0, (void*)&OD_record1A03},
+{0x1F22, 0x7F, 0x0A,  0, (void*)0},
 {0x1F80, 0x00, 0x8D,  4, (void*)&CO_OD_ROM.NMTStartup},
 {0x2100, 0x00, 0x36, 10, (void*)&CO_OD_RAM.errorStatusBits[0]},
 {0x2101, 0x00, 0x0D,  1, (void*)&CO_OD_ROM.CANNodeID},
@@ -378,6 +407,18 @@ const CO_OD_entry_t CO_OD[CO_OD_NoOfElements] = {
 {0x2105, 0x00, 0x3E,  1, (void*)&CO_OD_RAM.OPERATING_MODE},
 {0x2106, 0x00, 0x7E,  1, (void*)&CO_OD_RAM.OPERATING_MODE_DISPLAY},
 {0x2107, 0x00, 0x3E,  1, (void*)&CO_OD_RAM.STATUS_CODE},
+{0x2108, 0x0A, 0x8E,  4, (void*)&CO_OD_RAM.SYNCJitter[0]},
+{0x2110, 0x0A, 0x8E,  4, (void*)&CO_OD_RAM.TPDOSYNCLatency[0][0]},
+{0x2111, 0x0A, 0x8E,  4, (void*)&CO_OD_RAM.TPDOSYNCLatency[1][0]},
+{0x2112, 0x0A, 0x8E,  4, (void*)&CO_OD_RAM.TPDOSYNCLatency[2][0]},
+{0x2113, 0x0A, 0x8E,  4, (void*)&CO_OD_RAM.TPDOSYNCLatency[3][0]},
+{0x2114, 0x04, 0x8E,  4, (void*)&CO_OD_RAM.TPDOSYNCOffset[0]},
+{0x2115, 0x04, 0x8E,  4, (void*)&CO_OD_RAM.TPDOEventTimeUs[0]},
+{0x2116, 0x04, 0x0E,  1, (void*)&CO_OD_RAM.TPDOGroup[0]},
+{0x2118, 0x07, 0x8E,  4, (void*)&CO_OD_RAM.RPDOStatistics[0][0]},
+{0x2119, 0x07, 0x8E,  4, (void*)&CO_OD_RAM.RPDOStatistics[1][0]},
+{0x211A, 0x07, 0x8E,  4, (void*)&CO_OD_RAM.RPDOStatistics[2][0]},
+{0x211B, 0x07, 0x8E,  4, (void*)&CO_OD_RAM.RPDOStatistics[3][0]},
 {0x2200, 0x00, 0xBE,  2, (void*)&CO_OD_RAM.JOINT_FORCE_CONSTANT},
 {0x2201, 0x00, 0xBE,  2, (void*)&CO_OD_RAM.JOINT_POSITION_CONSTANT},
 {0x2202, 0x00, 0xBE,  2, (void*)&CO_OD_RAM.JOINT_VELOCITY_CONSTANT},